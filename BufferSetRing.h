@@ -0,0 +1,111 @@
+/** @file
+    @brief Header
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Sensics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_BufferSetRing_h_GUID_6E2A9C47_D813_4B5F_A07E_91C3F65B28D4
+#define INCLUDED_BufferSetRing_h_GUID_6E2A9C47_D813_4B5F_A07E_91C3F65B28D4
+
+// Internal Includes
+// - none
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+/// A fixed number of slots (e.g. sets of render buffers) handed out to the
+/// frames in flight, so each frame keeps its own copy while newer frames are
+/// written into other slots. The ring also keeps the latest complete frame
+/// around, for presenting again.
+///
+/// A slot is written only by whoever acquire()d it, while nobody else holds
+/// it; after that, any thread may read it until it release()s its hold.
+/// Storage is allocated once up front, and a small mutex guards just the
+/// hold counts, so no call allocates or waits on a frame.
+template <typename T> class BufferSetRing {
+  public:
+    /// Returned instead of a slot index when there is none.
+    static const std::size_t npos = static_cast<std::size_t>(-1);
+
+    explicit BufferSetRing(std::size_t count)
+        : slots_(count), holds_(count, 0) {}
+
+    std::size_t size() const { return slots_.size(); }
+
+    T &operator[](std::size_t i) { return slots_[i]; }
+    T const &operator[](std::size_t i) const { return slots_[i]; }
+
+    /// Holds a slot that nobody else holds, to write a new frame into.
+    /// Returns npos if every slot is held.
+    std::size_t acquire() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (std::size_t i = 0; i < holds_.size(); ++i) {
+            if (holds_[i] == 0) {
+                holds_[i] = 1;
+                return i;
+            }
+        }
+        return npos;
+    }
+
+    /// Drops one hold on slot @p i.
+    void release(std::size_t i) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        --holds_[i];
+    }
+
+    /// Makes slot @p i, which the caller holds and has finished writing,
+    /// the latest complete one. The ring holds on to it until a newer one
+    /// replaces it.
+    void publish(std::size_t i) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++holds_[i];
+        if (latest_ != npos) {
+            --holds_[latest_];
+        }
+        latest_ = i;
+    }
+
+    /// Holds and returns the latest complete slot, or npos if nothing has
+    /// been published yet.
+    std::size_t acquireLatest() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (latest_ != npos) {
+            ++holds_[latest_];
+        }
+        return latest_;
+    }
+
+  private:
+    std::vector<T> slots_;
+    std::mutex mutex_;
+    std::vector<int> holds_;
+    std::size_t latest_ = npos;
+};
+
+template <typename T> const std::size_t BufferSetRing<T>::npos;
+
+#endif // INCLUDED_BufferSetRing_h_GUID_6E2A9C47_D813_4B5F_A07E_91C3F65B28D4
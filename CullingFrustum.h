@@ -0,0 +1,256 @@
+/** @file
+    @brief Header
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Sensics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_CullingFrustum_h_GUID_9A4E27C3_5B18_4F6D_8E0C_D31B76F2A945
+#define INCLUDED_CullingFrustum_h_GUID_9A4E27C3_5B18_4F6D_8E0C_D31B76F2A945
+
+// Internal Includes
+// - none
+
+// Library/third-party includes
+#include <osvr/RenderKit/RenderKitGraphicsTransforms.h>
+#include <osvr/Util/Pose3C.h>
+
+// Standard includes
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+/// @name Combined culling frustum
+///
+/// One frustum enclosing the view frusta of all eyes, so a single culling
+/// pass can serve them all. Eye poses are world-from-eye, looking down -Z,
+/// and projections give the extents of the view at the near plane, both as
+/// in RenderManager's RenderInfo.
+/// @{
+
+namespace cullingfrustum {
+
+enum Plane { Left, Right, Bottom, Top, Near, Far, PlaneCount };
+
+struct Frustum {
+    /// Apex and orientation of the frustum (looking down -Z).
+    OSVR_PoseState origin;
+    /// Extents at the near plane, relative to the origin.
+    osvr::renderkit::OSVR_ProjectionMatrix projection;
+    /// World-space planes (a, b, c, d), indexed by Plane: unit normals point
+    /// inwards, so points inside have ax + by + cz + d >= 0. In the
+    /// right-handed space of the eye poses; see toUnityPlanes.
+    double planes[PlaneCount][4];
+};
+
+/// The planes of @p frustum in Unity's left-handed world space, which is
+/// OSVR's with z negated (as with the view matrices in EyeMatrices.h): the
+/// same planes, with c negated.
+inline void toUnityPlanes(Frustum const &frustum,
+                          double (&out)[PlaneCount][4]) {
+    for (int i = 0; i < PlaneCount; ++i) {
+        out[i][0] = frustum.planes[i][0];
+        out[i][1] = frustum.planes[i][1];
+        out[i][2] = -frustum.planes[i][2];
+        out[i][3] = frustum.planes[i][3];
+    }
+}
+
+namespace detail {
+struct Vec3 {
+    double x, y, z;
+};
+
+/// Rotates @p v by the unit quaternion (w, x, y, z) in @p q.
+inline Vec3 rotate(const double (&q)[4], Vec3 const &v) {
+    const double w = q[0], qx = q[1], qy = q[2], qz = q[3];
+    // t = 2 * cross(q.xyz, v); v' = v + w * t + cross(q.xyz, t)
+    const double tx = 2. * (qy * v.z - qz * v.y);
+    const double ty = 2. * (qz * v.x - qx * v.z);
+    const double tz = 2. * (qx * v.y - qy * v.x);
+    return Vec3{v.x + w * tx + (qy * tz - qz * ty),
+                v.y + w * ty + (qz * tx - qx * tz),
+                v.z + w * tz + (qx * ty - qy * tx)};
+}
+
+inline void normalizedRotation(OSVR_Quaternion const &in, double (&out)[4]) {
+    const double norm = std::sqrt(in.data[0] * in.data[0] +
+                                  in.data[1] * in.data[1] +
+                                  in.data[2] * in.data[2] +
+                                  in.data[3] * in.data[3]);
+    if (norm == 0.) {
+        // Poses that were never filled in: treat as identity.
+        out[0] = 1.;
+        out[1] = out[2] = out[3] = 0.;
+        return;
+    }
+    for (int i = 0; i < 4; ++i) {
+        out[i] = in.data[i] / norm;
+    }
+}
+} // namespace detail
+
+/// Computes a frustum containing the view frusta of @p count eyes. Its
+/// orientation is the average of the eyes' and its side planes have the
+/// widest slopes of any eye, pulled back so every eye's frustum corners are
+/// inside. Returns false if there are no eyes or their views are too far
+/// apart (over 90 degrees) to share a frustum.
+inline bool compute(const OSVR_PoseState *poses,
+                    const osvr::renderkit::OSVR_ProjectionMatrix *projections,
+                    std::size_t count, Frustum &out) {
+    using detail::Vec3;
+    using detail::rotate;
+    if (count == 0) {
+        return false;
+    }
+    // Reference orientation: the sign-aligned sum of the eye orientations,
+    // normalized, which is close to their average when they're similar.
+    static const std::size_t kMaxEyes = 16;
+    count = std::min(count, kMaxEyes);
+    double rotations[kMaxEyes][4];
+    double sum[4] = {};
+    for (std::size_t eye = 0; eye < count; ++eye) {
+        detail::normalizedRotation(poses[eye].rotation, rotations[eye]);
+        const double dot = sum[0] * rotations[eye][0] +
+                           sum[1] * rotations[eye][1] +
+                           sum[2] * rotations[eye][2] +
+                           sum[3] * rotations[eye][3];
+        const double sign = dot < 0. ? -1. : 1.;
+        for (int i = 0; i < 4; ++i) {
+            sum[i] += sign * rotations[eye][i];
+        }
+    }
+    OSVR_Quaternion refRotation;
+    for (int i = 0; i < 4; ++i) {
+        refRotation.data[i] = sum[i];
+    }
+    double ref[4];
+    detail::normalizedRotation(refRotation, ref);
+    const double refInverse[4] = {ref[0], -ref[1], -ref[2], -ref[3]};
+
+    // Corners of each eye's frustum (and the eye position) in the reference
+    // frame; slopes are tangents of the view direction, as in the
+    // projection.
+    static const std::size_t kCorners = 8;
+    Vec3 corners[kMaxEyes][kCorners];
+    const double inf = std::numeric_limits<double>::infinity();
+    double minX = inf, maxX = -inf, minY = inf, maxY = -inf;
+    for (std::size_t eye = 0; eye < count; ++eye) {
+        auto const &p = projections[eye];
+        if (!(p.nearClip > 0.) || !(p.farClip > p.nearClip) ||
+            !(p.right > p.left) || !(p.top > p.bottom)) {
+            return false;
+        }
+        auto const &t = poses[eye].translation.data;
+        const Vec3 eyePos = rotate(refInverse, Vec3{t[0], t[1], t[2]});
+        const double scale = p.farClip / p.nearClip;
+        for (std::size_t c = 0; c < kCorners; ++c) {
+            const double s = c < 4 ? 1. : scale;
+            const Vec3 local = {s * ((c & 1) ? p.right : p.left),
+                                s * ((c & 2) ? p.top : p.bottom),
+                                -s * p.nearClip};
+            const Vec3 world = rotate(rotations[eye], local);
+            const Vec3 v = rotate(refInverse, world);
+            corners[eye][c] = Vec3{v.x + eyePos.x, v.y + eyePos.y,
+                                   v.z + eyePos.z};
+            const double depth = -v.z;
+            if (depth <= 1e-6 * p.nearClip) {
+                return false;
+            }
+            minX = std::min(minX, v.x / depth);
+            maxX = std::max(maxX, v.x / depth);
+            minY = std::min(minY, v.y / depth);
+            maxY = std::max(maxY, v.y / depth);
+        }
+    }
+
+    // With the slopes fixed, a side plane through apex a holds the points
+    // with x + slope * z >= a.x + slope * a.z (left, with <= for right):
+    // find the tightest offsets, then an apex that satisfies each pair.
+    double left = inf, right = -inf, bottom = inf, top = -inf;
+    for (std::size_t eye = 0; eye < count; ++eye) {
+        for (auto const &v : corners[eye]) {
+            left = std::min(left, v.x + minX * v.z);
+            right = std::max(right, v.x + maxX * v.z);
+            bottom = std::min(bottom, v.y + minY * v.z);
+            top = std::max(top, v.y + maxY * v.z);
+        }
+    }
+    // Where each pair of planes meets; the apex must be at or behind both.
+    const double apexZ = std::max((left - right) / (minX - maxX),
+                                  (bottom - top) / (minY - maxY));
+    // Any x (y) between the pair's limits works; split the slack evenly.
+    const Vec3 apex = {0.5 * ((right - maxX * apexZ) + (left - minX * apexZ)),
+                       0.5 * ((top - maxY * apexZ) + (bottom - minY * apexZ)),
+                       apexZ};
+    double nearClip = inf, farClip = 0.;
+    for (std::size_t eye = 0; eye < count; ++eye) {
+        for (auto const &v : corners[eye]) {
+            nearClip = std::min(nearClip, apex.z - v.z);
+            farClip = std::max(farClip, apex.z - v.z);
+        }
+    }
+    if (!(nearClip > 0.)) {
+        return false;
+    }
+
+    const Vec3 origin = rotate(ref, apex);
+    out.origin.translation.data[0] = origin.x;
+    out.origin.translation.data[1] = origin.y;
+    out.origin.translation.data[2] = origin.z;
+    for (int i = 0; i < 4; ++i) {
+        out.origin.rotation.data[i] = ref[i];
+    }
+    out.projection.left = minX * nearClip;
+    out.projection.right = maxX * nearClip;
+    out.projection.bottom = minY * nearClip;
+    out.projection.top = maxY * nearClip;
+    out.projection.nearClip = nearClip;
+    out.projection.farClip = farClip;
+
+    // Planes in the reference frame, then rotated to world space (the
+    // reference frame shares the world origin, so d is unchanged).
+    const double local[PlaneCount][4] = {
+        {1., 0., minX, -(apex.x + minX * apex.z)},
+        {-1., 0., -maxX, apex.x + maxX * apex.z},
+        {0., 1., minY, -(apex.y + minY * apex.z)},
+        {0., -1., -maxY, apex.y + maxY * apex.z},
+        {0., 0., -1., apex.z - nearClip},
+        {0., 0., 1., farClip - apex.z}};
+    for (int i = 0; i < PlaneCount; ++i) {
+        const double length =
+            std::sqrt(local[i][0] * local[i][0] + local[i][1] * local[i][1] +
+                      local[i][2] * local[i][2]);
+        const Vec3 n = rotate(ref, Vec3{local[i][0] / length,
+                                        local[i][1] / length,
+                                        local[i][2] / length});
+        out.planes[i][0] = n.x;
+        out.planes[i][1] = n.y;
+        out.planes[i][2] = n.z;
+        out.planes[i][3] = local[i][3] / length;
+    }
+    return true;
+}
+} // namespace cullingfrustum
+
+/// @}
+
+#endif // INCLUDED_CullingFrustum_h_GUID_9A4E27C3_5B18_4F6D_8E0C_D31B76F2A945
@@ -0,0 +1,306 @@
+/** @file
+    @brief Header
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Sensics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef INCLUDED_DistortionMesh_h_GUID_8A3D52F1_6C07_4E9B_9D14_E2B07F6A18C3
+#define INCLUDED_DistortionMesh_h_GUID_8A3D52F1_6C07_4E9B_9D14_E2B07F6A18C3
+
+// Internal Includes
+// - none
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <vector>
+
+/// @name Distortion mesh generation
+///
+/// Builds per-eye distortion meshes from radially symmetric per-color
+/// polynomials, the way RenderManager's rgb_symmetric_polynomials
+/// distortion is described: offsets from the center of projection (COP) are
+/// divided by the distance scale D, their length r is mapped through the
+/// polynomial, and the result is scaled back by D.
+/// @{
+
+namespace distortionmesh {
+
+enum Color { Red = 0, Green = 1, Blue = 2, ColorCount = 3 };
+
+/// The distortion of one eye; all coordinates are normalized (0 to 1)
+/// texture coordinates.
+struct EyeDistortion {
+    std::array<float, 2> centerOfProjection;
+    std::array<float, 2> distanceScale;
+    /// Indexed by Color, lowest order coefficient first.
+    std::array<std::vector<float>, ColorCount> polynomials;
+};
+
+/// A regular grid over one eye's screen area.
+struct Mesh {
+    /// Vertices along each side.
+    int gridSize = 0;
+    /// Screen positions, x and y interleaved.
+    std::vector<float> positions;
+    /// Indexed by Color: where that color samples the rendered image, for
+    /// each position, x and y interleaved.
+    std::array<std::vector<float>, ColorCount> texCoords;
+    /// Two triangles per grid cell.
+    std::vector<std::uint32_t> indices;
+};
+
+/// Vertices per side of the smallest grid with at least @p desiredTriangles
+/// triangles.
+inline int gridSizeFor(std::size_t desiredTriangles) {
+    auto cells = static_cast<int>(
+        std::ceil(std::sqrt(static_cast<double>(desiredTriangles) / 2.)));
+    return (cells < 1 ? 1 : cells) + 1;
+}
+
+/// Fills in the positions and indices of an undistorted grid.
+inline void buildGrid(int gridSize, Mesh &mesh) {
+    mesh.gridSize = gridSize;
+    const auto n = static_cast<std::size_t>(gridSize);
+    mesh.positions.resize(n * n * 2);
+    const float step = 1.f / static_cast<float>(gridSize - 1);
+    for (std::size_t row = 0; row < n; ++row) {
+        for (std::size_t col = 0; col < n; ++col) {
+            mesh.positions[(row * n + col) * 2] = col * step;
+            mesh.positions[(row * n + col) * 2 + 1] = row * step;
+        }
+    }
+    mesh.indices.clear();
+    mesh.indices.reserve((n - 1) * (n - 1) * 6);
+    for (std::size_t row = 0; row + 1 < n; ++row) {
+        for (std::size_t col = 0; col + 1 < n; ++col) {
+            const auto i = static_cast<std::uint32_t>(row * n + col);
+            const auto below = static_cast<std::uint32_t>(i + n);
+            const std::uint32_t cell[] = {i, i + 1, below + 1,
+                                          i, below + 1, below};
+            mesh.indices.insert(mesh.indices.end(), cell, cell + 6);
+        }
+    }
+}
+
+/// Computes one color's texture coordinates for the positions in @p mesh.
+/// The work is split into flat loops over structure-of-arrays scratch
+/// (polynomials by Horner's rule, one coefficient at a time across every
+/// vertex), which compilers vectorize.
+inline void distortColor(EyeDistortion const &eye, Color color,
+                         Mesh &mesh) {
+    const std::size_t n = mesh.positions.size() / 2;
+    const float copX = eye.centerOfProjection[0];
+    const float copY = eye.centerOfProjection[1];
+    const float dX = eye.distanceScale[0];
+    const float dY = eye.distanceScale[1];
+    const float invDX = 1.f / dX;
+    const float invDY = 1.f / dY;
+    std::vector<float> x(n), y(n), r(n), rNew(n, 0.f);
+    const float *pos = mesh.positions.data();
+    for (std::size_t i = 0; i < n; ++i) {
+        x[i] = (pos[2 * i] - copX) * invDX;
+        y[i] = (pos[2 * i + 1] - copY) * invDY;
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+        r[i] = std::sqrt(x[i] * x[i] + y[i] * y[i]);
+    }
+    auto const &poly = eye.polynomials[color];
+    for (std::size_t k = poly.size(); k-- > 0;) {
+        const float c = poly[k];
+        for (std::size_t i = 0; i < n; ++i) {
+            rNew[i] = rNew[i] * r[i] + c;
+        }
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+        // At the COP itself the direction is undefined; the point stays.
+        r[i] = r[i] > 0.f ? rNew[i] / r[i] : 1.f;
+    }
+    auto &out = mesh.texCoords[color];
+    out.resize(n * 2);
+    for (std::size_t i = 0; i < n; ++i) {
+        out[2 * i] = copX + dX * x[i] * r[i];
+        out[2 * i + 1] = copY + dY * y[i] * r[i];
+    }
+}
+
+/// Builds one mesh per eye with at least @p desiredTriangles triangles each,
+/// distorting every eye and color on its own thread. May throw
+/// std::system_error if threads can't be started.
+inline void generate(std::vector<EyeDistortion> const &eyes,
+                     std::size_t desiredTriangles, std::vector<Mesh> &meshes) {
+    meshes.resize(eyes.size());
+    if (eyes.empty()) {
+        return;
+    }
+    // Every eye shares the same undistorted grid.
+    buildGrid(gridSizeFor(desiredTriangles), meshes[0]);
+    for (std::size_t e = 1; e < eyes.size(); ++e) {
+        meshes[e].gridSize = meshes[0].gridSize;
+        meshes[e].positions = meshes[0].positions;
+        meshes[e].indices = meshes[0].indices;
+    }
+    std::vector<std::future<void>> tasks;
+    tasks.reserve(eyes.size() * ColorCount);
+    for (std::size_t e = 0; e < eyes.size(); ++e) {
+        for (int c = 0; c < ColorCount; ++c) {
+            tasks.push_back(std::async(std::launch::async, [&, e, c] {
+                distortColor(eyes[e], static_cast<Color>(c), meshes[e]);
+            }));
+        }
+    }
+    for (auto &task : tasks) {
+        task.get();
+    }
+}
+
+/// The part of one eye's rendered image that the distortion never samples,
+/// in the same normalized texture coordinates as Mesh::texCoords.
+struct HiddenAreaMesh {
+    /// x and y interleaved.
+    std::vector<float> vertices;
+    /// Triangles, in no particular winding order.
+    std::vector<std::uint32_t> indices;
+};
+
+/// Where the ray from @p origin through @p point leaves the unit square;
+/// @p edge is set to 0, 1, 2 or 3 for the left, right, bottom or top edge.
+inline std::array<float, 2> rayToUnitSquare(std::array<float, 2> origin,
+                                            std::array<float, 2> point,
+                                            int &edge) {
+    const float dx = point[0] - origin[0];
+    const float dy = point[1] - origin[1];
+    float t = 1e30f;
+    edge = -1;
+    if (dx < 0.f) {
+        t = -origin[0] / dx;
+        edge = 0;
+    } else if (dx > 0.f) {
+        t = (1.f - origin[0]) / dx;
+        edge = 1;
+    }
+    if (dy < 0.f && -origin[1] / dy < t) {
+        t = -origin[1] / dy;
+        edge = 2;
+    } else if (dy > 0.f && (1.f - origin[1]) / dy < t) {
+        t = (1.f - origin[1]) / dy;
+        edge = 3;
+    }
+    return {{origin[0] + t * dx, origin[1] + t * dy}};
+}
+
+/// Builds the hidden area of the image as seen through @p mesh: the region
+/// between the outline of what the screen edges sample (for each direction
+/// from the center of projection, the color reaching furthest out) and the
+/// edges of the image. Assumes the distortion is radial about the center of
+/// projection, so the sampled region is star-shaped around it.
+inline void buildHiddenArea(EyeDistortion const &eye, Mesh const &mesh,
+                            HiddenAreaMesh &out) {
+    out.vertices.clear();
+    out.indices.clear();
+    const int n = mesh.gridSize;
+    if (n < 2) {
+        return;
+    }
+    // The outer ring of grid vertices, counterclockwise from the bottom left.
+    std::vector<int> ring;
+    ring.reserve(4 * (n - 1));
+    for (int col = 0; col < n - 1; ++col) {
+        ring.push_back(col);
+    }
+    for (int row = 0; row < n - 1; ++row) {
+        ring.push_back(row * n + n - 1);
+    }
+    for (int col = n - 1; col > 0; --col) {
+        ring.push_back((n - 1) * n + col);
+    }
+    for (int row = n - 1; row > 0; --row) {
+        ring.push_back(row * n);
+    }
+
+    const std::array<float, 2> cop = eye.centerOfProjection;
+    std::vector<int> edges;
+    edges.reserve(ring.size());
+    for (int v : ring) {
+        // The color sampling furthest from the center.
+        std::array<float, 2> inner = cop;
+        float innerDist = -1.f;
+        for (auto const &texCoords : mesh.texCoords) {
+            const float x = texCoords[2 * v] - cop[0];
+            const float y = texCoords[2 * v + 1] - cop[1];
+            if (x * x + y * y > innerDist) {
+                innerDist = x * x + y * y;
+                inner = {{texCoords[2 * v], texCoords[2 * v + 1]}};
+            }
+        }
+        int edge;
+        const auto outer = rayToUnitSquare(cop, inner, edge);
+        const float ox = outer[0] - cop[0];
+        const float oy = outer[1] - cop[1];
+        if (edge < 0 || innerDist >= ox * ox + oy * oy) {
+            // Sampled all the way to the edge (or beyond) in this direction.
+            inner = outer;
+        }
+        out.vertices.insert(out.vertices.end(),
+                            {inner[0], inner[1], outer[0], outer[1]});
+        edges.push_back(edge);
+    }
+
+    auto samePoint = [&](std::uint32_t a, std::uint32_t b) {
+        return out.vertices[2 * a] == out.vertices[2 * b] &&
+               out.vertices[2 * a + 1] == out.vertices[2 * b + 1];
+    };
+    const auto count = static_cast<std::uint32_t>(ring.size());
+    for (std::uint32_t i = 0; i < count; ++i) {
+        const std::uint32_t j = (i + 1) % count;
+        const std::uint32_t innerI = 2 * i, outerI = 2 * i + 1;
+        const std::uint32_t innerJ = 2 * j, outerJ = 2 * j + 1;
+        // Nothing hidden between two rays sampled all the way out.
+        if (!samePoint(innerI, outerI) || !samePoint(innerJ, outerJ)) {
+            out.indices.insert(out.indices.end(), {innerI, outerI, outerJ,
+                                                   innerI, outerJ, innerJ});
+        }
+        // The quad cuts across the image corner between two edges: fill it.
+        const int a = edges[i];
+        const int b = edges[j];
+        if (a >= 0 && b >= 0 && a / 2 != b / 2) {
+            const int vertical = a < 2 ? a : b;
+            const int horizontal = a < 2 ? b : a;
+            const auto corner = static_cast<std::uint32_t>(
+                out.vertices.size() / 2);
+            out.vertices.push_back(vertical == 0 ? 0.f : 1.f);
+            out.vertices.push_back(horizontal == 2 ? 0.f : 1.f);
+            out.indices.insert(out.indices.end(), {outerI, corner, outerJ});
+        }
+    }
+}
+} // namespace distortionmesh
+
+/// @}
+
+#endif // INCLUDED_DistortionMesh_h_GUID_8A3D52F1_6C07_4E9B_9D14_E2B07F6A18C3
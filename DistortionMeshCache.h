@@ -0,0 +1,332 @@
+/** @file
+    @brief Header
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Sensics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef INCLUDED_DistortionMeshCache_h_GUID_0E6B93A4_7D21_4F5C_A8E3_5C49B1F2D760
+#define INCLUDED_DistortionMeshCache_h_GUID_0E6B93A4_7D21_4F5C_A8E3_5C49B1F2D760
+
+// Internal Includes
+#include "DistortionMesh.h"
+#include "PluginConfig.h"
+#include "RenderInfoCache.h"
+
+// Library/third-party includes
+#if UNITY_WIN
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Standard includes
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/// @name Distortion mesh cache
+///
+/// Generated distortion meshes, stored in the temp directory in files named
+/// after a hash of everything that went into generating them, and memory
+/// mapped when read back. The file is written in native byte order; a file
+/// whose header, size or checksum doesn't check out is ignored (and then
+/// overwritten).
+/// @{
+
+namespace distortionmeshcache {
+
+static const std::uint32_t kMagic = 0x4f53564d; // "OSVM"
+static const std::uint32_t kVersion = 1;
+/// Sanity limits for reading, well above anything generated in practice.
+static const std::uint32_t kMaxEyes = 16;
+static const std::uint32_t kMaxGridSize = 4096;
+
+/// Followed by the payload: the positions (2 floats per vertex) and indices
+/// shared by all eyes, then for each eye and color, the texture coordinates
+/// (2 floats per vertex).
+struct Header {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint64_t key;
+    std::uint32_t eyeCount;
+    std::uint32_t gridSize;
+    std::uint32_t vertexCount;
+    std::uint32_t indexCount;
+    /// hashWords() of the payload.
+    std::uint64_t payloadChecksum;
+    /// hashWords() of everything above.
+    std::uint64_t headerChecksum;
+};
+
+/// FNV-1a over 64-bit words rather than bytes: about eight times faster
+/// than renderinfocache::hashBytes, which matters for a payload of a few
+/// hundred kilobytes.
+inline std::uint64_t hashWords(const void *data, std::size_t size,
+                               std::uint64_t hash = 14695981039346656037ull) {
+    auto bytes = static_cast<const unsigned char *>(data);
+    std::size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, bytes + i, 8);
+        hash ^= word;
+        hash *= 1099511628211ull;
+    }
+    return renderinfocache::hashBytes(bytes + i, size - i, hash);
+}
+
+/// Identifies the meshes generate() makes from these inputs.
+inline std::uint64_t key(std::vector<distortionmesh::EyeDistortion> const &eyes,
+                         std::size_t desiredTriangles, int meshType) {
+    const std::uint64_t header[] = {kVersion, eyes.size(), desiredTriangles,
+                                    static_cast<std::uint64_t>(meshType)};
+    auto hash = hashWords(header, sizeof(header));
+    for (auto const &eye : eyes) {
+        hash = hashWords(eye.centerOfProjection.data(),
+                         sizeof(eye.centerOfProjection), hash);
+        hash = hashWords(eye.distanceScale.data(), sizeof(eye.distanceScale),
+                         hash);
+        for (auto const &poly : eye.polynomials) {
+            const std::uint64_t length = poly.size();
+            hash = hashWords(&length, sizeof(length), hash);
+            hash = hashWords(poly.data(), poly.size() * sizeof(float), hash);
+        }
+    }
+    return hash;
+}
+
+inline std::string pathFor(std::uint64_t key) {
+    char name[64];
+    std::snprintf(name, sizeof(name),
+                  "osvrUnityRenderingPlugin-mesh-%016llx.bin",
+                  static_cast<unsigned long long>(key));
+    return renderinfocache::tempDirectory() + name;
+}
+
+/// A read-only memory mapping of a whole file.
+class MappedFile {
+  public:
+    explicit MappedFile(std::string const &path) {
+#if UNITY_WIN
+        file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                            nullptr);
+        if (file_ == INVALID_HANDLE_VALUE) {
+            return;
+        }
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file_, &size) || size.QuadPart == 0) {
+            return;
+        }
+        mapping_ =
+            CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping_ == nullptr) {
+            return;
+        }
+        data_ = MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+        if (data_ != nullptr) {
+            size_ = static_cast<std::size_t>(size.QuadPart);
+        }
+#else
+        fd_ = open(path.c_str(), O_RDONLY);
+        if (fd_ < 0) {
+            return;
+        }
+        struct stat st;
+        if (fstat(fd_, &st) != 0 || st.st_size == 0) {
+            return;
+        }
+        void *data = mmap(nullptr, static_cast<std::size_t>(st.st_size),
+                          PROT_READ, MAP_PRIVATE, fd_, 0);
+        if (data != MAP_FAILED) {
+            data_ = data;
+            size_ = static_cast<std::size_t>(st.st_size);
+        }
+#endif
+    }
+
+    ~MappedFile() {
+#if UNITY_WIN
+        if (data_ != nullptr) {
+            UnmapViewOfFile(data_);
+        }
+        if (mapping_ != nullptr) {
+            CloseHandle(mapping_);
+        }
+        if (file_ != INVALID_HANDLE_VALUE) {
+            CloseHandle(file_);
+        }
+#else
+        if (data_ != nullptr) {
+            munmap(data_, size_);
+        }
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+#endif
+    }
+
+    MappedFile(MappedFile const &) = delete;
+    MappedFile &operator=(MappedFile const &) = delete;
+
+    /// nullptr if the file couldn't be mapped.
+    const unsigned char *data() const {
+        return static_cast<const unsigned char *>(data_);
+    }
+    std::size_t size() const { return size_; }
+
+  private:
+    void *data_ = nullptr;
+    std::size_t size_ = 0;
+#if UNITY_WIN
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+};
+
+inline std::size_t payloadSize(Header const &h) {
+    return (static_cast<std::size_t>(h.vertexCount) * 2 *
+                (1 + static_cast<std::size_t>(h.eyeCount) *
+                         distortionmesh::ColorCount)) *
+               sizeof(float) +
+           static_cast<std::size_t>(h.indexCount) * sizeof(std::uint32_t);
+}
+
+/// Reads the meshes for @p key from @p path. Returns false, leaving
+/// @p meshes alone, if the file is missing, invalid or for another key.
+inline bool load(std::string const &path, std::uint64_t key,
+                 std::vector<distortionmesh::Mesh> &meshes) {
+    MappedFile file(path);
+    if (file.data() == nullptr || file.size() < sizeof(Header)) {
+        return false;
+    }
+    Header h;
+    std::memcpy(&h, file.data(), sizeof(h));
+    if (h.magic != kMagic || h.version != kVersion || h.key != key ||
+        h.headerChecksum != hashWords(&h, offsetof(Header, headerChecksum)) ||
+        h.eyeCount == 0 || h.eyeCount > kMaxEyes || h.gridSize < 2 ||
+        h.gridSize > kMaxGridSize ||
+        h.vertexCount != h.gridSize * h.gridSize ||
+        h.indexCount != (h.gridSize - 1) * (h.gridSize - 1) * 6 ||
+        file.size() != sizeof(Header) + payloadSize(h)) {
+        return false;
+    }
+    const unsigned char *payload = file.data() + sizeof(Header);
+    if (hashWords(payload, payloadSize(h)) != h.payloadChecksum) {
+        return false;
+    }
+    const std::size_t coords = static_cast<std::size_t>(h.vertexCount) * 2;
+    auto floats = [&](std::size_t offset) {
+        return reinterpret_cast<const float *>(payload + offset);
+    };
+    std::vector<distortionmesh::Mesh> ret(h.eyeCount);
+    std::size_t offset = 0;
+    ret[0].positions.assign(floats(offset), floats(offset) + coords);
+    offset += coords * sizeof(float);
+    const auto indices =
+        reinterpret_cast<const std::uint32_t *>(payload + offset);
+    ret[0].indices.assign(indices, indices + h.indexCount);
+    offset += h.indexCount * sizeof(std::uint32_t);
+    for (auto &mesh : ret) {
+        mesh.gridSize = static_cast<int>(h.gridSize);
+        if (&mesh != &ret[0]) {
+            mesh.positions = ret[0].positions;
+            mesh.indices = ret[0].indices;
+        }
+        for (auto &texCoords : mesh.texCoords) {
+            texCoords.assign(floats(offset), floats(offset) + coords);
+            offset += coords * sizeof(float);
+        }
+    }
+    meshes.swap(ret);
+    return true;
+}
+
+/// Writes @p meshes (as made by distortionmesh::generate, so sharing one
+/// grid) next to @p path and then moves the file into place, so a reader
+/// never maps half a file.
+inline bool save(std::string const &path, std::uint64_t key,
+                 std::vector<distortionmesh::Mesh> const &meshes) {
+    if (meshes.empty()) {
+        return false;
+    }
+    auto const &first = meshes[0];
+    Header h = {};
+    h.magic = kMagic;
+    h.version = kVersion;
+    h.key = key;
+    h.eyeCount = static_cast<std::uint32_t>(meshes.size());
+    h.gridSize = static_cast<std::uint32_t>(first.gridSize);
+    h.vertexCount = static_cast<std::uint32_t>(first.positions.size() / 2);
+    h.indexCount = static_cast<std::uint32_t>(first.indices.size());
+
+    std::vector<unsigned char> payload;
+    payload.reserve(payloadSize(h));
+    auto append = [&](const void *data, std::size_t size) {
+        auto bytes = static_cast<const unsigned char *>(data);
+        payload.insert(payload.end(), bytes, bytes + size);
+    };
+    append(first.positions.data(), first.positions.size() * sizeof(float));
+    append(first.indices.data(),
+           first.indices.size() * sizeof(std::uint32_t));
+    for (auto const &mesh : meshes) {
+        for (auto const &texCoords : mesh.texCoords) {
+            if (texCoords.size() != first.positions.size()) {
+                return false;
+            }
+            append(texCoords.data(), texCoords.size() * sizeof(float));
+        }
+    }
+    h.payloadChecksum = hashWords(payload.data(), payload.size());
+    h.headerChecksum = hashWords(&h, offsetof(Header, headerChecksum));
+
+    const std::string tempPath = path + ".tmp";
+    std::FILE *f = std::fopen(tempPath.c_str(), "wb");
+    if (f == nullptr) {
+        return false;
+    }
+    const bool written =
+        std::fwrite(&h, sizeof(h), 1, f) == 1 &&
+        std::fwrite(payload.data(), payload.size(), 1, f) == 1;
+    if (std::fclose(f) != 0 || !written) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    // rename() won't replace an existing file on Windows.
+    std::remove(path.c_str());
+    return std::rename(tempPath.c_str(), path.c_str()) == 0;
+}
+} // namespace distortionmeshcache
+
+/// @}
+
+#endif // INCLUDED_DistortionMeshCache_h_GUID_0E6B93A4_7D21_4F5C_A8E3_5C49B1F2D760
@@ -0,0 +1,176 @@
+/** @file
+    @brief Header
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Sensics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_EyeMatrices_h_GUID_3F8D61A2_C74B_4E95_B0D6_8A2E5C19F7B3
+#define INCLUDED_EyeMatrices_h_GUID_3F8D61A2_C74B_4E95_B0D6_8A2E5C19F7B3
+
+// Internal Includes
+// - none
+
+// Library/third-party includes
+#include <osvr/RenderKit/RenderKitGraphicsTransforms.h>
+#include <osvr/Util/Pose3C.h>
+
+// Standard includes
+#include <algorithm>
+#include <cstddef>
+
+/// @name Unity eye matrices
+///
+/// View and projection matrices in the form Unity's Matrix4x4 takes them:
+/// floats, column-major (element (row, col) at [col * 4 + row]).
+///
+/// Unity's world is left-handed (+Z forward) while OSVR's is right-handed
+/// (-Z forward), so the view matrix maps Unity world space, through the
+/// z flip, into the eye space of the OSVR pose. That eye space is the
+/// right-handed, -Z forward camera space Unity's worldToCameraMatrix uses.
+/// @{
+
+namespace eyematrices {
+
+/// Depth range of clip space the projection maps to.
+enum class ClipSpace {
+    /// -1 at the near plane to 1 at the far plane, as Unity wants for
+    /// Camera.projectionMatrix on every platform.
+    OpenGL,
+    /// 0 to 1, as Direct3D uses.
+    D3D,
+    /// 1 to 0, as Unity uses on Direct3D 11 from 5.5 on.
+    D3DReversedZ
+};
+
+/// Writes the view matrices for @p count poses, each world-from-eye as in
+/// RenderManager's RenderInfo. Works on batches of eyes laid out structure
+/// of arrays style, so the compiler can vectorize the quaternion to matrix
+/// conversion across eyes.
+inline void viewMatrices(const OSVR_PoseState *poses, std::size_t count,
+                         float (*out)[16]) {
+    static const std::size_t kBatch = 8;
+    for (std::size_t first = 0; first < count; first += kBatch) {
+        const std::size_t n = std::min(kBatch, count - first);
+        double w[kBatch] = {}, x[kBatch] = {}, y[kBatch] = {}, z[kBatch] = {};
+        double tx[kBatch] = {}, ty[kBatch] = {}, tz[kBatch] = {};
+        for (std::size_t i = 0; i < n; ++i) {
+            auto const &p = poses[first + i];
+            w[i] = p.rotation.data[0];
+            x[i] = p.rotation.data[1];
+            y[i] = p.rotation.data[2];
+            z[i] = p.rotation.data[3];
+            tx[i] = p.translation.data[0];
+            ty[i] = p.translation.data[1];
+            tz[i] = p.translation.data[2];
+        }
+        // r<row><col> of the world-from-eye rotation. Scaling by
+        // 2 / |q|^2 copes with quaternions that aren't quite unit length; a
+        // zero quaternion (a pose never filled in) gives the identity.
+        double r00[kBatch], r01[kBatch], r02[kBatch];
+        double r10[kBatch], r11[kBatch], r12[kBatch];
+        double r20[kBatch], r21[kBatch], r22[kBatch];
+        for (std::size_t i = 0; i < kBatch; ++i) {
+            const double norm2 =
+                w[i] * w[i] + x[i] * x[i] + y[i] * y[i] + z[i] * z[i];
+            const double s = norm2 > 0. ? 2. / norm2 : 0.;
+            const double xx = s * x[i] * x[i], yy = s * y[i] * y[i],
+                         zz = s * z[i] * z[i];
+            const double xy = s * x[i] * y[i], xz = s * x[i] * z[i],
+                         yz = s * y[i] * z[i];
+            const double wx = s * w[i] * x[i], wy = s * w[i] * y[i],
+                         wz = s * w[i] * z[i];
+            r00[i] = 1. - (yy + zz);
+            r01[i] = xy - wz;
+            r02[i] = xz + wy;
+            r10[i] = xy + wz;
+            r11[i] = 1. - (xx + zz);
+            r12[i] = yz - wx;
+            r20[i] = xz - wy;
+            r21[i] = yz + wx;
+            r22[i] = 1. - (xx + yy);
+        }
+        // The view matrix is eye-from-world (R^T, -R^T t) times the z flip
+        // from Unity's world to OSVR's, which negates its third column.
+        for (std::size_t i = 0; i < n; ++i) {
+            float *m = out[first + i];
+            m[0] = static_cast<float>(r00[i]);
+            m[1] = static_cast<float>(r01[i]);
+            m[2] = static_cast<float>(r02[i]);
+            m[3] = 0.f;
+            m[4] = static_cast<float>(r10[i]);
+            m[5] = static_cast<float>(r11[i]);
+            m[6] = static_cast<float>(r12[i]);
+            m[7] = 0.f;
+            m[8] = static_cast<float>(-r20[i]);
+            m[9] = static_cast<float>(-r21[i]);
+            m[10] = static_cast<float>(-r22[i]);
+            m[11] = 0.f;
+            m[12] = static_cast<float>(
+                -(r00[i] * tx[i] + r10[i] * ty[i] + r20[i] * tz[i]));
+            m[13] = static_cast<float>(
+                -(r01[i] * tx[i] + r11[i] * ty[i] + r21[i] * tz[i]));
+            m[14] = static_cast<float>(
+                -(r02[i] * tx[i] + r12[i] * ty[i] + r22[i] * tz[i]));
+            m[15] = 1.f;
+        }
+    }
+}
+
+/// Writes the projection for @p p, whose extents are at the near plane as
+/// with glFrustum. Y is not flipped for rendering into textures on
+/// Direct3D; Unity's GL.GetGPUProjectionMatrix does that if needed.
+inline void projectionMatrix(osvr::renderkit::OSVR_ProjectionMatrix const &p,
+                             ClipSpace clipSpace, float (&out)[16]) {
+    const double n = p.nearClip;
+    const double f = p.farClip;
+    const double width = p.right - p.left;
+    const double height = p.top - p.bottom;
+    const double depth = f - n;
+    std::fill(out, out + 16, 0.f);
+    if (width == 0. || height == 0. || depth == 0.) {
+        return;
+    }
+    out[0] = static_cast<float>(2. * n / width);
+    out[5] = static_cast<float>(2. * n / height);
+    out[8] = static_cast<float>((p.right + p.left) / width);
+    out[9] = static_cast<float>((p.top + p.bottom) / height);
+    out[11] = -1.f;
+    // Third row: maps eye-space z (-n to -f) to the clip depth range.
+    switch (clipSpace) {
+    case ClipSpace::OpenGL:
+        out[10] = static_cast<float>(-(f + n) / depth);
+        out[14] = static_cast<float>(-2. * f * n / depth);
+        break;
+    case ClipSpace::D3D:
+        out[10] = static_cast<float>(-f / depth);
+        out[14] = static_cast<float>(-f * n / depth);
+        break;
+    case ClipSpace::D3DReversedZ:
+        out[10] = static_cast<float>(n / depth);
+        out[14] = static_cast<float>(f * n / depth);
+        break;
+    }
+}
+} // namespace eyematrices
+
+/// @}
+
+#endif // INCLUDED_EyeMatrices_h_GUID_3F8D61A2_C74B_4E95_B0D6_8A2E5C19F7B3
@@ -0,0 +1,139 @@
+/** @file
+    @brief Header
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Sensics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_FrameQueue_h_GUID_9B04E6D3_51A7_4C2F_B8E0_36D7A1C9F452
+#define INCLUDED_FrameQueue_h_GUID_9B04E6D3_51A7_4C2F_B8E0_36D7A1C9F452
+
+// Internal Includes
+// - none
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+/// What push() does when the queue is already full.
+enum class FrameQueueFullPolicy {
+    /// Wait for the consumer to make room (back-pressure on the producer).
+    Block,
+    /// Throw away the oldest queued frame to make room.
+    DropOldest
+};
+
+/// What happened to a frame handed to push().
+enum class FrameQueuePushResult {
+    Queued,
+    /// Queued, but the oldest queued frame was dropped to make room.
+    QueuedDroppingOldest,
+    /// Not queued: the queue has been closed.
+    Closed
+};
+
+/// Bounded single-producer/single-consumer queue of frames. Storage is
+/// allocated once up front, so pushing and popping never allocate.
+template <typename T> class FrameQueue {
+  public:
+    explicit FrameQueue(std::size_t capacity)
+        : slots_(capacity == 0 ? 1 : capacity) {}
+
+    /// Adds a frame, handling a full queue according to @p policy. If the
+    /// oldest frame gets dropped, it is moved into @p dropped (if given), so
+    /// the caller can release what it holds.
+    FrameQueuePushResult push(T const &frame, FrameQueueFullPolicy policy,
+                              T *dropped = nullptr) {
+        auto ret = FrameQueuePushResult::Queued;
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (policy == FrameQueueFullPolicy::Block) {
+            notFull_.wait(lock,
+                          [&] { return closed_ || count_ < slots_.size(); });
+        } else if (!closed_ && count_ == slots_.size()) {
+            if (dropped != nullptr) {
+                *dropped = slots_[head_];
+            }
+            head_ = (head_ + 1) % slots_.size();
+            --count_;
+            ret = FrameQueuePushResult::QueuedDroppingOldest;
+        }
+        if (closed_) {
+            return FrameQueuePushResult::Closed;
+        }
+        slots_[(head_ + count_) % slots_.size()] = frame;
+        ++count_;
+        depth_ = count_;
+        lock.unlock();
+        notEmpty_.notify_one();
+        return ret;
+    }
+
+    /// Waits for a frame and removes it into @p frame. Returns false once the
+    /// queue is closed and empty.
+    bool pop(T &frame) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notEmpty_.wait(lock, [&] { return closed_ || count_ > 0; });
+        if (count_ == 0) {
+            return false;
+        }
+        frame = slots_[head_];
+        head_ = (head_ + 1) % slots_.size();
+        --count_;
+        depth_ = count_;
+        lock.unlock();
+        notFull_.notify_one();
+        return true;
+    }
+
+    /// Wakes up both sides and makes further push() calls fail; pop() still
+    /// drains what's queued.
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        notEmpty_.notify_all();
+        notFull_.notify_all();
+    }
+
+    std::size_t capacity() const { return slots_.size(); }
+
+    /// Current number of queued frames; readable from any thread without
+    /// locking.
+    std::size_t depth() const { return depth_; }
+
+  private:
+    std::mutex mutex_;
+    std::condition_variable notEmpty_;
+    std::condition_variable notFull_;
+    std::vector<T> slots_;
+    std::size_t head_ = 0;
+    std::size_t count_ = 0;
+    bool closed_ = false;
+    std::atomic<std::size_t> depth_{0};
+};
+
+#endif // INCLUDED_FrameQueue_h_GUID_9B04E6D3_51A7_4C2F_B8E0_36D7A1C9F452
@@ -0,0 +1,135 @@
+/** @file
+    @brief Header
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Sensics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_FrameStats_h_GUID_2D6F8B13_C4E7_4A59_A0D2_7F35B9E18C66
+#define INCLUDED_FrameStats_h_GUID_2D6F8B13_C4E7_4A59_A0D2_7F35B9E18C66
+
+// Internal Includes
+// - none
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/// Histogram of durations in the style of HdrHistogram: buckets are powers of
+/// two of microseconds, each split linearly into kSubBuckets, so any value is
+/// stored with about 1/kSubBuckets relative precision. Recording is lock-free
+/// (one relaxed atomic increment plus a max update), so it can be done from
+/// the render thread while other threads read.
+class LatencyHistogram {
+  public:
+    static const int kSubBucketBits = 3;
+    static const int kSubBuckets = 1 << kSubBucketBits;
+    /// Covers up to 2^kMagnitudes microseconds (over a minute).
+    static const int kMagnitudes = 26;
+    static const int kBuckets = (kMagnitudes + 1) * kSubBuckets;
+
+    void record(double microseconds) {
+        const auto us = microseconds <= 0.
+                            ? std::uint64_t(0)
+                            : static_cast<std::uint64_t>(microseconds + 0.5);
+        counts_[bucketIndex(us)].fetch_add(1, std::memory_order_relaxed);
+        auto prevMax = max_.load(std::memory_order_relaxed);
+        while (us > prevMax &&
+               !max_.compare_exchange_weak(prevMax, us,
+                                           std::memory_order_relaxed)) {
+        }
+    }
+
+    struct Summary {
+        std::uint64_t count;
+        double p50;
+        double p95;
+        double p99;
+        double max;
+    };
+
+    /// Percentiles are the upper edge of the bucket they fall in, in
+    /// microseconds. Concurrent recording may make them slightly stale.
+    Summary summarize() const {
+        std::array<std::uint64_t, kBuckets> counts;
+        std::uint64_t total = 0;
+        for (int i = 0; i < kBuckets; ++i) {
+            counts[i] = counts_[i].load(std::memory_order_relaxed);
+            total += counts[i];
+        }
+        Summary ret = {};
+        ret.count = total;
+        ret.max = static_cast<double>(max_.load(std::memory_order_relaxed));
+        if (total == 0) {
+            return ret;
+        }
+        const double fractions[] = {0.5, 0.95, 0.99};
+        double *outputs[] = {&ret.p50, &ret.p95, &ret.p99};
+        for (int p = 0; p < 3; ++p) {
+            const auto target = static_cast<std::uint64_t>(
+                fractions[p] * static_cast<double>(total - 1)) + 1;
+            std::uint64_t seen = 0;
+            for (int i = 0; i < kBuckets; ++i) {
+                seen += counts[i];
+                if (seen >= target) {
+                    *outputs[p] = std::min(bucketUpperEdge(i), ret.max);
+                    break;
+                }
+            }
+        }
+        return ret;
+    }
+
+  private:
+    static int bucketIndex(std::uint64_t us) {
+        if (us < kSubBuckets) {
+            // First magnitude: one bucket per microsecond.
+            return static_cast<int>(us);
+        }
+        int magnitude = 0;
+        while ((us >> (magnitude + kSubBucketBits)) != 0 &&
+               magnitude < kMagnitudes) {
+            ++magnitude;
+        }
+        const auto sub = static_cast<int>((us >> (magnitude - 1)) &
+                                          (kSubBuckets - 1));
+        return magnitude * kSubBuckets + sub;
+    }
+
+    static double bucketUpperEdge(int index) {
+        const int magnitude = index / kSubBuckets;
+        const int sub = index % kSubBuckets;
+        if (magnitude == 0) {
+            return static_cast<double>(sub);
+        }
+        const double width = static_cast<double>(1ull << (magnitude - 1));
+        return (kSubBuckets + sub + 1) * width - 1.;
+    }
+
+    std::array<std::atomic<std::uint64_t>, kBuckets> counts_ = {};
+    std::atomic<std::uint64_t> max_{0};
+};
+
+#endif // INCLUDED_FrameStats_h_GUID_2D6F8B13_C4E7_4A59_A0D2_7F35B9E18C66
@@ -0,0 +1,214 @@
+/** @file
+    @brief Header
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Sensics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_FrameTrace_h_GUID_E4C2A915_0F6B_4D83_9B7A_58E31D2C6F04
+#define INCLUDED_FrameTrace_h_GUID_E4C2A915_0F6B_4D83_9B7A_58E31D2C6F04
+
+// Internal Includes
+// - none
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+/// @name Frame timing trace
+///
+/// OSVR_TRACE_ZONE("name") records how long the rest of the enclosing scope
+/// takes. Each thread records into its own lock-free ring buffer, so a zone
+/// costs two clock reads and a few stores; writeChromeTrace() dumps the
+/// recent zones of all threads as Chrome trace-event JSON (chrome://tracing).
+///
+/// Unless OSVR_UNITY_ENABLE_TRACING is defined, the macro expands to nothing.
+/// @{
+
+namespace frametrace {
+typedef std::chrono::steady_clock Clock;
+
+struct Event {
+    /// Must be a string literal (or otherwise live forever).
+    const char *name;
+    std::int64_t startNs;
+    std::int64_t durationNs;
+};
+
+/// Single-writer ring of the most recent events of one thread.
+struct ThreadRing {
+    static const std::size_t kCapacity = 1 << 14;
+    std::array<Event, kCapacity> events;
+    /// Total number of events ever written.
+    std::atomic<std::uint64_t> head{0};
+    int threadIndex = 0;
+
+    void push(Event const &e) {
+        const auto h = head.load(std::memory_order_relaxed);
+        events[h % kCapacity] = e;
+        head.store(h + 1, std::memory_order_release);
+    }
+};
+
+static const int kMaxThreads = 32;
+
+/// One ring per slot, created the first time a thread takes the slot and
+/// never freed, so the export can read the rings of threads that have
+/// exited. A thread gives its slot back when it exits; the next thread to
+/// take it keeps writing into the same ring (and shows up under the same
+/// tid), so threads that get restarted, like the plugin's present and
+/// timewarp threads on each reconfigure or device reset, don't use up
+/// slots.
+struct Registry {
+    std::array<std::atomic<ThreadRing *>, kMaxThreads> rings;
+    std::array<std::atomic<bool>, kMaxThreads> taken;
+};
+
+inline Registry &registry() {
+    static Registry reg;
+    return reg;
+}
+
+/// Holds a registry slot for as long as its thread lives.
+class SlotOwner {
+  public:
+    SlotOwner() {
+        auto &reg = registry();
+        for (int i = 0; i < kMaxThreads; ++i) {
+            bool expected = false;
+            if (!reg.taken[i].compare_exchange_strong(
+                    expected, true, std::memory_order_acquire)) {
+                continue;
+            }
+            slot_ = i;
+            ring_ = reg.rings[i].load(std::memory_order_acquire);
+            if (ring_ == nullptr) {
+                ring_ = new ThreadRing;
+                ring_->threadIndex = i;
+                reg.rings[i].store(ring_, std::memory_order_release);
+            }
+            return;
+        }
+    }
+    ~SlotOwner() {
+        if (ring_ != nullptr) {
+            registry().taken[slot_].store(false, std::memory_order_release);
+        }
+    }
+    SlotOwner(SlotOwner const &) = delete;
+    SlotOwner &operator=(SlotOwner const &) = delete;
+
+    ThreadRing *ring() const { return ring_; }
+
+  private:
+    int slot_ = -1;
+    ThreadRing *ring_ = nullptr;
+};
+
+/// This thread's ring, taken on first use; nullptr if kMaxThreads other
+/// threads are recording already.
+inline ThreadRing *threadRing() {
+    static thread_local SlotOwner owner;
+    return owner.ring();
+}
+
+inline std::int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               Clock::now().time_since_epoch())
+        .count();
+}
+
+/// RAII zone: records an event covering its lifetime.
+class Zone {
+  public:
+    explicit Zone(const char *name) : name_(name), start_(nowNs()) {}
+    ~Zone() {
+        if (auto ring = threadRing()) {
+            ring->push(Event{name_, start_, nowNs() - start_});
+        }
+    }
+    Zone(Zone const &) = delete;
+    Zone &operator=(Zone const &) = delete;
+
+  private:
+    const char *name_;
+    std::int64_t start_;
+};
+
+/// Writes the events of the last @p seconds to @p path as Chrome trace-event
+/// JSON. Events still being overwritten by a busy thread may be skipped.
+inline bool writeChromeTrace(const char *path, double seconds) {
+    std::FILE *f = std::fopen(path, "w");
+    if (f == nullptr) {
+        return false;
+    }
+    const auto cutoff = nowNs() - static_cast<std::int64_t>(seconds * 1e9);
+    auto &reg = registry();
+    bool first = true;
+    std::fprintf(f, "{\"traceEvents\":[");
+    for (int t = 0; t < kMaxThreads; ++t) {
+        ThreadRing *ring = reg.rings[t].load(std::memory_order_acquire);
+        if (ring == nullptr) {
+            continue;
+        }
+        const auto head = ring->head.load(std::memory_order_acquire);
+        // Leave some slack at the old end: the writer may be lapping it.
+        const std::uint64_t slack = 64;
+        const auto available = head < ThreadRing::kCapacity - slack
+                                   ? head
+                                   : ThreadRing::kCapacity - slack;
+        for (auto i = head - available; i < head; ++i) {
+            const Event e = ring->events[i % ThreadRing::kCapacity];
+            if (e.startNs < cutoff || e.name == nullptr) {
+                continue;
+            }
+            std::fprintf(f,
+                         "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,"
+                         "\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                         first ? "" : ",", e.name, ring->threadIndex,
+                         e.startNs / 1000., e.durationNs / 1000.);
+            first = false;
+        }
+    }
+    std::fprintf(f, "\n]}\n");
+    return std::fclose(f) == 0;
+}
+} // namespace frametrace
+
+#if defined(OSVR_UNITY_ENABLE_TRACING)
+#define OSVR_TRACE_CONCAT_IMPL(A, B) A##B
+#define OSVR_TRACE_CONCAT(A, B) OSVR_TRACE_CONCAT_IMPL(A, B)
+#define OSVR_TRACE_ZONE(NAME)                                                  \
+    ::frametrace::Zone OSVR_TRACE_CONCAT(osvrTraceZone_, __LINE__)(NAME)
+#else
+#define OSVR_TRACE_ZONE(NAME)                                                  \
+    do {                                                                       \
+    } while (0)
+#endif
+
+/// @}
+
+#endif // INCLUDED_FrameTrace_h_GUID_E4C2A915_0F6B_4D83_9B7A_58E31D2C6F04
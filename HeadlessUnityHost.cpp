@@ -0,0 +1,1544 @@
+/** @file
+    @brief Implementation of a headless stand-in for the Unity player, used to
+    drive and profile the rendering plugin without Unity.
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Sensics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Internal Includes
+#include "DistortionMesh.h"
+#include "OsvrRenderingPlugin.h"
+#include "PoseHistory.h"
+#include "Unity/IUnityGraphics.h"
+#include "Unity/IUnityInterface.h"
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if UNITY_WIN
+#define NO_MINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <malloc.h>
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+// Must match the RenderEvents enum in OsvrRenderingPlugin.cpp
+enum RenderEvents {
+    kOsvrEventID_Render = 0,
+    kOsvrEventID_Shutdown = 1,
+    kOsvrEventID_Update = 2,
+    kOsvrEventID_Reconfigure = 5,
+};
+
+using Clock = std::chrono::steady_clock;
+
+// --------------------------------------------------------------------------
+// Heap allocation counting
+//
+// The host replaces every form of the global operator new (and exports
+// them, see CMakeLists.txt) so that allocations made by the plugin on the
+// simulated render thread can be counted, whichever form the plugin or the
+// standard library ends up calling.
+
+static thread_local bool s_countAllocations = false;
+static std::atomic<std::uint64_t> s_allocationCount{0};
+
+// Every operator delete below pairs with one of the operator news here, all
+// on malloc and free, but GCC assumes operator new never comes from malloc
+// and warns wherever it inlines one of these deletes next to a new.
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+static void *countedMalloc(std::size_t size) noexcept {
+    if (s_countAllocations) {
+        ++s_allocationCount;
+    }
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void *operator new(std::size_t size) {
+    if (void *ret = countedMalloc(size)) {
+        return ret;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size, std::nothrow_t const &) noexcept {
+    return countedMalloc(size);
+}
+
+void *operator new[](std::size_t size) { return operator new(size); }
+
+void *operator new[](std::size_t size, std::nothrow_t const &) noexcept {
+    return countedMalloc(size);
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+
+void operator delete(void *ptr, std::nothrow_t const &) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+
+void operator delete[](void *ptr, std::nothrow_t const &) noexcept {
+    std::free(ptr);
+}
+
+#if defined(__cpp_sized_deallocation)
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+
+void operator delete[](void *ptr, std::size_t) noexcept { std::free(ptr); }
+#endif // __cpp_sized_deallocation
+
+#if defined(__cpp_aligned_new)
+static void *countedAlignedMalloc(std::size_t size,
+                                  std::align_val_t alignment) noexcept {
+    if (s_countAllocations) {
+        ++s_allocationCount;
+    }
+    const auto align = std::max(static_cast<std::size_t>(alignment),
+                                sizeof(void *));
+#if UNITY_WIN
+    return _aligned_malloc(size == 0 ? 1 : size, align);
+#else
+    void *ret = nullptr;
+    return posix_memalign(&ret, align, size == 0 ? 1 : size) == 0 ? ret
+                                                                   : nullptr;
+#endif
+}
+
+static void alignedFree(void *ptr) noexcept {
+#if UNITY_WIN
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+    if (void *ret = countedAlignedMalloc(size, alignment)) {
+        return ret;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment,
+                   std::nothrow_t const &) noexcept {
+    return countedAlignedMalloc(size, alignment);
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment,
+                     std::nothrow_t const &) noexcept {
+    return countedAlignedMalloc(size, alignment);
+}
+
+void operator delete(void *ptr, std::align_val_t) noexcept {
+    alignedFree(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t,
+                     std::nothrow_t const &) noexcept {
+    alignedFree(ptr);
+}
+
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept {
+    alignedFree(ptr);
+}
+
+void operator delete[](void *ptr, std::align_val_t) noexcept {
+    alignedFree(ptr);
+}
+
+void operator delete[](void *ptr, std::align_val_t,
+                       std::nothrow_t const &) noexcept {
+    alignedFree(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept {
+    alignedFree(ptr);
+}
+#endif // __cpp_aligned_new
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic pop
+#endif
+
+/// Counts the allocations made on this thread while it's alive.
+class AllocationCountingScope {
+  public:
+    AllocationCountingScope() { s_countAllocations = true; }
+    ~AllocationCountingScope() { s_countAllocations = false; }
+};
+
+// --------------------------------------------------------------------------
+// Command line options
+
+struct HostOptions {
+    std::string pluginPath = OSVR_UNITY_PLUGIN_PATH;
+    UnityGfxRenderer renderer = kUnityGfxRendererNull;
+    double rateHz = 90.;
+    double durationSeconds = 5.;
+    bool runGetters = true;
+    bool useMockBackend = true;
+    double mockRefreshRateHz = 90.;
+    int maxFramesInFlight = 0;
+    int queuePolicy = OSVR_UNITY_PRESENT_QUEUE_BLOCK;
+    bool checkAllocations = false;
+    std::string tracePath;
+    int textureLayout = OSVR_UNITY_STEREO_TEXTURE_PER_EYE;
+    bool asyncCreate = false;
+    int reconfigureEvery = 0;
+    int resetEvery = 0;
+    bool timewarp = false;
+    int skipEvery = 0;
+    int skipRenderEvery = 0;
+    double renderWorkSeconds = 0.;
+    bool reprojectionFallback = false;
+    int distortionBenchmarkRuns = 0;
+    int distortionTriangles = 12800;
+    bool distortionCache = true;
+    bool checkCullingFrustum = false;
+    bool checkEyeMatrices = false;
+    bool checkPoseHistory = false;
+    bool checkGLTextures = false;
+    bool posePrediction = false;
+    /// Negative for the plugin's measured lead.
+    double predictionLeadSeconds = -1.;
+    std::string recordTrajectoryPath;
+    std::string replayTrajectoryPath;
+    bool checkDistortion = false;
+    bool contention = false;
+};
+
+/// Frames to run before counting allocations, so one-time setup in the
+/// first frames doesn't count.
+static const int kWarmupFrames = 30;
+
+static void printUsage(const char *argv0) {
+    std::printf(
+        "Usage: %s [options]\n"
+        "  --plugin <path>      Plugin module to load (default: %s)\n"
+        "  --renderer <name>    Renderer to report: null, opengl, d3d11\n"
+        "                       (default: null)\n"
+        "  --rate <hz>          Render event rate (default: 90)\n"
+        "  --duration <sec>     How long to run (default: 5)\n"
+        "  --no-getters         Don't call the main-thread getters\n"
+        "  --contention         Send Update events back to back, with no\n"
+        "                       Render events, so the getters race a render\n"
+        "                       info update that is always in progress\n"
+        "  --backend <name>     mock: create the plugin's mock render\n"
+        "                       backend; none: don't create a backend\n"
+        "                       (default: mock)\n"
+        "  --vsync-hz <hz>      Mock backend refresh rate, 0 for no vsync\n"
+        "                       wait (default: 90)\n"
+        "  --present-thread <n> Present from the plugin's present thread\n"
+        "                       with up to n frames in flight\n"
+        "  --drop-oldest        Drop the oldest queued frame instead of\n"
+        "                       blocking when the present queue is full\n"
+        "  --check-allocations  Fail if the plugin allocates on the render\n"
+        "                       thread once warmed up (with the mock\n"
+        "                       backend; RenderManager itself allocates\n"
+        "                       render info every frame)\n"
+        "  --trace <path>       Write the plugin's frame trace (Chrome\n"
+        "                       trace-event JSON) at the end of the run\n"
+        "  --texture-layout <name>\n"
+        "                       Stereo texture layout: per-eye,\n"
+        "                       side-by-side, array (default: per-eye)\n"
+        "  --async              Create the backend with\n"
+        "                       CreateRenderManagerFromUnityAsync\n"
+        "  --reconfigure-every <n>\n"
+        "                       Every n frames, hand the plugin a new eye 1\n"
+        "                       texture and send a reconfigure event\n"
+        "  --reset-every <n>    Every n frames, send BeforeReset and\n"
+        "                       AfterReset device events\n"
+        "  --timewarp           Run the plugin's timewarp thread\n"
+        "  --skip-every <n>     Every n frames, skip the Update and Render\n"
+        "                       events, as if Unity had missed a frame\n"
+        "  --skip-render-every <n>\n"
+        "                       Every n frames, send Update but skip the\n"
+        "                       Render event\n"
+        "  --render-work <ms>   Wait this long between each Update and\n"
+        "                       Render event, as Unity would drawing the\n"
+        "                       eyes (default: 0)\n"
+        "  --reprojection-fallback\n"
+        "                       Enable the plugin's synchronous reprojection\n"
+        "                       of missed frames\n"
+        "  --distortion-benchmark <n>\n"
+        "                       Call UpdateDistortionMesh n times from the\n"
+        "                       main thread while rendering\n"
+        "  --distortion-triangles <n>\n"
+        "                       Triangles per eye for the distortion\n"
+        "                       benchmark (default: 12800)\n"
+        "  --no-distortion-cache\n"
+        "                       Generate the distortion meshes every time\n"
+        "  --check-distortion   Instead of running the plugin, fail if the\n"
+        "                       distortion mesh generator disagrees with\n"
+        "                       stored texture coordinates\n"
+        "  --check-culling-frustum\n"
+        "                       Fail if an eye's frustum pokes out of the\n"
+        "                       combined culling frustum\n"
+        "  --check-eye-matrices Fail if GetEyeMatrices disagrees with the\n"
+        "                       poses and projections\n"
+        "  --check-pose-history Fail if GetEyePoseAtTime disagrees with the\n"
+        "                       poses at their own timestamps (ignored with\n"
+        "                       --pose-prediction)\n"
+        "  --check-gl-textures  Report OpenGL, hand the plugin texture names\n"
+        "                       and fail unless the mock backend gets them\n"
+        "                       registered unchanged\n"
+        "  --pose-prediction <ms|measured>\n"
+        "                       Have the plugin predict poses this far ahead\n"
+        "  --record-trajectory <path>\n"
+        "                       Write the eye 0 poses as measured to a file\n"
+        "  --replay-trajectory <path>\n"
+        "                       Instead of running the plugin, predict\n"
+        "                       along a recorded trajectory at the\n"
+        "                       --pose-prediction lead (default: 20 ms) and\n"
+        "                       fail unless that beats not predicting\n",
+        argv0, OSVR_UNITY_PLUGIN_PATH);
+}
+
+static bool parseOptions(int argc, char *argv[], HostOptions &opts) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto hasValue = [&] { return i + 1 < argc; };
+        if (arg == "--plugin" && hasValue()) {
+            opts.pluginPath = argv[++i];
+        } else if (arg == "--renderer" && hasValue()) {
+            std::string r = argv[++i];
+            if (r == "null") {
+                opts.renderer = kUnityGfxRendererNull;
+            } else if (r == "opengl") {
+                opts.renderer = kUnityGfxRendererOpenGL;
+            } else if (r == "d3d11") {
+                opts.renderer = kUnityGfxRendererD3D11;
+            } else {
+                std::fprintf(stderr, "Unknown renderer '%s'\n", r.c_str());
+                return false;
+            }
+        } else if (arg == "--rate" && hasValue()) {
+            opts.rateHz = std::atof(argv[++i]);
+        } else if (arg == "--duration" && hasValue()) {
+            opts.durationSeconds = std::atof(argv[++i]);
+        } else if (arg == "--no-getters") {
+            opts.runGetters = false;
+        } else if (arg == "--contention") {
+            opts.contention = true;
+        } else if (arg == "--backend" && hasValue()) {
+            std::string b = argv[++i];
+            if (b == "mock") {
+                opts.useMockBackend = true;
+            } else if (b == "none") {
+                opts.useMockBackend = false;
+            } else {
+                std::fprintf(stderr, "Unknown backend '%s'\n", b.c_str());
+                return false;
+            }
+        } else if (arg == "--vsync-hz" && hasValue()) {
+            opts.mockRefreshRateHz = std::atof(argv[++i]);
+        } else if (arg == "--present-thread" && hasValue()) {
+            opts.maxFramesInFlight = std::atoi(argv[++i]);
+        } else if (arg == "--drop-oldest") {
+            opts.queuePolicy = OSVR_UNITY_PRESENT_QUEUE_DROP_OLDEST;
+        } else if (arg == "--check-allocations") {
+            opts.checkAllocations = true;
+        } else if (arg == "--trace" && hasValue()) {
+            opts.tracePath = argv[++i];
+        } else if (arg == "--reconfigure-every" && hasValue()) {
+            opts.reconfigureEvery = std::atoi(argv[++i]);
+        } else if (arg == "--reset-every" && hasValue()) {
+            opts.resetEvery = std::atoi(argv[++i]);
+        } else if (arg == "--timewarp") {
+            opts.timewarp = true;
+        } else if (arg == "--skip-every" && hasValue()) {
+            opts.skipEvery = std::atoi(argv[++i]);
+        } else if (arg == "--skip-render-every" && hasValue()) {
+            opts.skipRenderEvery = std::atoi(argv[++i]);
+        } else if (arg == "--render-work" && hasValue()) {
+            opts.renderWorkSeconds = std::atof(argv[++i]) / 1000.;
+        } else if (arg == "--reprojection-fallback") {
+            opts.reprojectionFallback = true;
+        } else if (arg == "--distortion-benchmark" && hasValue()) {
+            opts.distortionBenchmarkRuns = std::atoi(argv[++i]);
+        } else if (arg == "--distortion-triangles" && hasValue()) {
+            opts.distortionTriangles = std::atoi(argv[++i]);
+        } else if (arg == "--no-distortion-cache") {
+            opts.distortionCache = false;
+        } else if (arg == "--check-distortion") {
+            opts.checkDistortion = true;
+        } else if (arg == "--check-culling-frustum") {
+            opts.checkCullingFrustum = true;
+        } else if (arg == "--check-eye-matrices") {
+            opts.checkEyeMatrices = true;
+        } else if (arg == "--check-pose-history") {
+            opts.checkPoseHistory = true;
+        } else if (arg == "--check-gl-textures") {
+            opts.checkGLTextures = true;
+        } else if (arg == "--pose-prediction" && hasValue()) {
+            std::string lead = argv[++i];
+            opts.posePrediction = true;
+            opts.predictionLeadSeconds =
+                lead == "measured" ? -1. : std::atof(lead.c_str()) / 1000.;
+        } else if (arg == "--record-trajectory" && hasValue()) {
+            opts.recordTrajectoryPath = argv[++i];
+        } else if (arg == "--replay-trajectory" && hasValue()) {
+            opts.replayTrajectoryPath = argv[++i];
+        } else if (arg == "--async") {
+            opts.asyncCreate = true;
+        } else if (arg == "--texture-layout" && hasValue()) {
+            std::string l = argv[++i];
+            if (l == "per-eye") {
+                opts.textureLayout = OSVR_UNITY_STEREO_TEXTURE_PER_EYE;
+            } else if (l == "side-by-side") {
+                opts.textureLayout = OSVR_UNITY_STEREO_TEXTURE_SIDE_BY_SIDE;
+            } else if (l == "array") {
+                opts.textureLayout = OSVR_UNITY_STEREO_TEXTURE_ARRAY;
+            } else {
+                std::fprintf(stderr, "Unknown texture layout '%s'\n",
+                             l.c_str());
+                return false;
+            }
+        } else {
+            return false;
+        }
+    }
+    return opts.rateHz > 0. && opts.durationSeconds > 0.;
+}
+
+// --------------------------------------------------------------------------
+// Stand-in Unity interfaces
+
+static UnityGfxRenderer s_hostRenderer = kUnityGfxRendererNull;
+static IUnityGraphicsDeviceEventCallback s_deviceEventCallback = nullptr;
+
+static UnityGfxRenderer UNITY_INTERFACE_API HostGetRenderer() {
+    return s_hostRenderer;
+}
+
+static void UNITY_INTERFACE_API
+HostRegisterDeviceEventCallback(IUnityGraphicsDeviceEventCallback callback) {
+    s_deviceEventCallback = callback;
+}
+
+static void UNITY_INTERFACE_API
+HostUnregisterDeviceEventCallback(IUnityGraphicsDeviceEventCallback callback) {
+    if (s_deviceEventCallback == callback) {
+        s_deviceEventCallback = nullptr;
+    }
+}
+
+/// IUnityGraphics derives from IUnityInterface, so it can't be
+/// aggregate-initialized.
+static IUnityGraphics makeHostGraphics() {
+    IUnityGraphics ret;
+    ret.GetRenderer = &HostGetRenderer;
+    ret.RegisterDeviceEventCallback = &HostRegisterDeviceEventCallback;
+    ret.UnregisterDeviceEventCallback = &HostUnregisterDeviceEventCallback;
+    return ret;
+}
+
+static IUnityGraphics s_hostGraphics = makeHostGraphics();
+
+static IUnityInterface *UNITY_INTERFACE_API
+HostGetInterface(UnityInterfaceGUID guid) {
+    if (guid == UNITY_GET_INTERFACE_GUID(IUnityGraphics)) {
+        return &s_hostGraphics;
+    }
+    return nullptr;
+}
+
+static void UNITY_INTERFACE_API HostRegisterInterface(UnityInterfaceGUID,
+                                                      IUnityInterface *) {}
+
+static IUnityInterfaces s_hostInterfaces = {HostGetInterface,
+                                            HostRegisterInterface};
+
+static void UNITY_INTERFACE_API HostDebugLog(const char *str) {
+    std::printf("[plugin] %s\n", str);
+}
+
+// --------------------------------------------------------------------------
+// Plugin module loading
+
+class PluginModule {
+  public:
+    explicit PluginModule(std::string const &path) {
+#if UNITY_WIN
+        handle_ = LoadLibraryA(path.c_str());
+#else
+        handle_ = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+#endif
+    }
+    ~PluginModule() {
+        if (handle_ == nullptr) {
+            return;
+        }
+#if UNITY_WIN
+        FreeLibrary(static_cast<HMODULE>(handle_));
+#else
+        dlclose(handle_);
+#endif
+    }
+    PluginModule(PluginModule const &) = delete;
+    PluginModule &operator=(PluginModule const &) = delete;
+
+    explicit operator bool() const { return handle_ != nullptr; }
+
+    /// Looks up an export and casts it to the type of @p fn; returns false if
+    /// it's missing.
+    template <typename F> bool get(const char *name, F &fn) const {
+#if UNITY_WIN
+        auto sym = GetProcAddress(static_cast<HMODULE>(handle_), name);
+#else
+        auto sym = dlsym(handle_, name);
+#endif
+        fn = reinterpret_cast<F>(sym);
+        if (fn == nullptr) {
+            std::fprintf(stderr, "Plugin is missing export '%s'\n", name);
+        }
+        return fn != nullptr;
+    }
+
+  private:
+    void *handle_ = nullptr;
+};
+
+/// The plugin exports we drive.
+struct PluginApi {
+    void(UNITY_INTERFACE_API *UnityPluginLoad)(IUnityInterfaces *);
+    void(UNITY_INTERFACE_API *UnityPluginUnload)();
+    void(UNITY_INTERFACE_API *LinkDebug)(DebugFnPtr);
+    UnityRenderingEvent(UNITY_INTERFACE_API *GetRenderEventFunc)();
+    OSVR_Pose3(UNITY_INTERFACE_API *GetEyePose)(int);
+    osvr::renderkit::OSVR_ProjectionMatrix(
+        UNITY_INTERFACE_API *GetProjectionMatrix)(int);
+    osvr::renderkit::OSVR_ViewportDescription(
+        UNITY_INTERFACE_API *GetViewport)(int);
+    int(UNITY_INTERFACE_API *GetAllEyeRenderData)(
+        OSVR_UnityEyeRenderData *, int, OSVR_UnityRenderDataHeader *);
+    void(UNITY_INTERFACE_API *SetRenderBackend)(int);
+    void(UNITY_INTERFACE_API *SetMockRenderBackendRefreshRate)(double);
+    OSVR_ReturnCode(UNITY_INTERFACE_API *CreateRenderManagerFromUnity)(
+        OSVR_ClientContext);
+    OSVR_ReturnCode(UNITY_INTERFACE_API *CreateRenderManagerFromUnityAsync)(
+        OSVR_ClientContext, OSVR_UnityRenderManagerStatusFnPtr);
+    int(UNITY_INTERFACE_API *GetRenderManagerStatus)(char *, int);
+    OSVR_ReturnCode(UNITY_INTERFACE_API *ConstructRenderBuffers)();
+    OSVR_ReturnCode(UNITY_INTERFACE_API *GetMockRenderBackendStats)(
+        OSVR_UnityMockRenderBackendStats *);
+    void(UNITY_INTERFACE_API *ShutdownRenderManager)();
+    void(UNITY_INTERFACE_API *SetPresentThreadMode)(int, int);
+    void(UNITY_INTERFACE_API *SetStereoTextureLayout)(int);
+    int(UNITY_INTERFACE_API *SetColorBufferFromUnity)(void *, int);
+    OSVR_ReturnCode(UNITY_INTERFACE_API *GetPresentQueueStats)(
+        OSVR_UnityPresentQueueStats *);
+    OSVR_ReturnCode(UNITY_INTERFACE_API *WriteFrameTrace)(const char *,
+                                                           double);
+    OSVR_ReturnCode(UNITY_INTERFACE_API *GetPluginFrameStats)(
+        OSVR_UnityPluginFrameStats *);
+    void(UNITY_INTERFACE_API *SetTimewarpThreadMode)(int, int, uint64_t);
+    void(UNITY_INTERFACE_API *SetReprojectionFallback)(int);
+    OSVR_ReturnCode(UNITY_INTERFACE_API *UpdateDistortionMesh)(
+        const OSVR_UnityDistortionParameters *, int, int);
+    void(UNITY_INTERFACE_API *SetDistortionMeshCache)(int);
+    OSVR_ReturnCode(UNITY_INTERFACE_API *GetHiddenAreaMesh)(
+        int, float *, int, int32_t *, int, int32_t *, int32_t *);
+    OSVR_ReturnCode(UNITY_INTERFACE_API *GetTimewarpStats)(
+        OSVR_UnityTimewarpStats *);
+    OSVR_ReturnCode(UNITY_INTERFACE_API *GetCullingFrustum)(
+        OSVR_UnityCullingFrustum *);
+    int(UNITY_INTERFACE_API *GetEyeMatrices)(OSVR_UnityEyeMatrices *, int, int,
+                                             OSVR_UnityRenderDataHeader *);
+    OSVR_ReturnCode(UNITY_INTERFACE_API *GetEyePoseAtTime)(int, OSVR_TimeValue,
+                                                           OSVR_Pose3 *);
+    void(UNITY_INTERFACE_API *SetPosePrediction)(int, double);
+
+    bool load(PluginModule const &m) {
+        return m.get("UnityPluginLoad", UnityPluginLoad) &&
+               m.get("UnityPluginUnload", UnityPluginUnload) &&
+               m.get("LinkDebug", LinkDebug) &&
+               m.get("GetRenderEventFunc", GetRenderEventFunc) &&
+               m.get("GetEyePose", GetEyePose) &&
+               m.get("GetProjectionMatrix", GetProjectionMatrix) &&
+               m.get("GetViewport", GetViewport) &&
+               m.get("GetAllEyeRenderData", GetAllEyeRenderData) &&
+               m.get("SetRenderBackend", SetRenderBackend) &&
+               m.get("SetMockRenderBackendRefreshRate",
+                     SetMockRenderBackendRefreshRate) &&
+               m.get("CreateRenderManagerFromUnity",
+                     CreateRenderManagerFromUnity) &&
+               m.get("CreateRenderManagerFromUnityAsync",
+                     CreateRenderManagerFromUnityAsync) &&
+               m.get("GetRenderManagerStatus", GetRenderManagerStatus) &&
+               m.get("ConstructRenderBuffers", ConstructRenderBuffers) &&
+               m.get("GetMockRenderBackendStats", GetMockRenderBackendStats) &&
+               m.get("ShutdownRenderManager", ShutdownRenderManager) &&
+               m.get("SetPresentThreadMode", SetPresentThreadMode) &&
+               m.get("SetStereoTextureLayout", SetStereoTextureLayout) &&
+               m.get("SetColorBufferFromUnity", SetColorBufferFromUnity) &&
+               m.get("GetPresentQueueStats", GetPresentQueueStats) &&
+               m.get("WriteFrameTrace", WriteFrameTrace) &&
+               m.get("GetPluginFrameStats", GetPluginFrameStats) &&
+               m.get("SetTimewarpThreadMode", SetTimewarpThreadMode) &&
+               m.get("SetReprojectionFallback", SetReprojectionFallback) &&
+               m.get("UpdateDistortionMesh", UpdateDistortionMesh) &&
+               m.get("SetDistortionMeshCache", SetDistortionMeshCache) &&
+               m.get("GetHiddenAreaMesh", GetHiddenAreaMesh) &&
+               m.get("GetTimewarpStats", GetTimewarpStats) &&
+               m.get("GetCullingFrustum", GetCullingFrustum) &&
+               m.get("GetEyeMatrices", GetEyeMatrices) &&
+               m.get("GetEyePoseAtTime", GetEyePoseAtTime) &&
+               m.get("SetPosePrediction", SetPosePrediction);
+    }
+};
+
+/// Runs distortionmesh::distortColor over a 3x3 grid with a known lens and
+/// compares each color's texture coordinates with ones worked out
+/// independently: the offset from the COP divided by the distance scale,
+/// its length mapped through the polynomial, scaled back.
+static bool checkDistortionGolden() {
+    distortionmesh::EyeDistortion eye;
+    eye.centerOfProjection = {{0.55f, 0.5f}};
+    eye.distanceScale = {{1.25f, 1.f}};
+    eye.polynomials[distortionmesh::Red] = {0.f, 1.02f, 0.f, 0.22f};
+    eye.polynomials[distortionmesh::Green] = {0.f, 1.f, 0.f, 0.2f};
+    eye.polynomials[distortionmesh::Blue] = {0.f, 0.98f, 0.f, 0.18f};
+    static const float expected[distortionmesh::ColorCount][18] = {
+        {-0.064676f, -0.058796f, 0.496232f, -0.037676f, 1.046580f,
+         -0.051756f, -0.034426f, 0.500000f, 0.498982f, 0.500000f, 1.021830f,
+         0.500000f, -0.064676f, 1.058796f, 0.496232f, 1.037676f, 1.046580f,
+         1.051756f},
+        {-0.048796f, -0.044360f, 0.497484f, -0.025160f, 1.034164f,
+         -0.037960f, -0.021296f, 0.500000f, 0.499984f, 0.500000f, 1.011664f,
+         0.500000f, -0.048796f, 1.044360f, 0.497484f, 1.025160f, 1.034164f,
+         1.037960f},
+        {-0.032916f, -0.029924f, 0.498736f, -0.012644f, 1.021748f,
+         -0.024164f, -0.008166f, 0.500000f, 0.500986f, 0.500000f, 1.001498f,
+         0.500000f, -0.032916f, 1.029924f, 0.498736f, 1.012644f, 1.021748f,
+         1.024164f}};
+    distortionmesh::Mesh mesh;
+    distortionmesh::buildGrid(3, mesh);
+    int wrong = 0;
+    for (int c = 0; c < distortionmesh::ColorCount; ++c) {
+        distortionmesh::distortColor(eye, static_cast<distortionmesh::Color>(c),
+                                     mesh);
+        auto const &texCoords = mesh.texCoords[c];
+        for (std::size_t i = 0; i < 18; ++i) {
+            if (texCoords.size() != 18 ||
+                std::fabs(texCoords[i] - expected[c][i]) > 1e-5f) {
+                ++wrong;
+            }
+        }
+    }
+    std::printf("distortion mesh: %d of %d texture coordinates wrong\n",
+                wrong, distortionmesh::ColorCount * 18);
+    return wrong == 0;
+}
+
+/// Reports how much of an eye's image its hidden-area mesh covers.
+static void printHiddenArea(PluginApi const &api, int eye) {
+    int32_t vertexCount = 0;
+    int32_t indexCount = 0;
+    if (api.GetHiddenAreaMesh(eye, nullptr, 0, nullptr, 0, &vertexCount,
+                              &indexCount) != OSVR_RETURN_SUCCESS) {
+        std::printf("hidden area: no mesh for eye %d\n", eye);
+        return;
+    }
+    std::vector<float> v(vertexCount * 2);
+    std::vector<int32_t> idx(indexCount);
+    api.GetHiddenAreaMesh(eye, v.data(), vertexCount, idx.data(), indexCount,
+                          &vertexCount, &indexCount);
+    double area = 0.;
+    for (std::size_t t = 0; t + 2 < idx.size(); t += 3) {
+        const float *a = &v[2 * idx[t]];
+        const float *b = &v[2 * idx[t + 1]];
+        const float *c = &v[2 * idx[t + 2]];
+        area += 0.5 * std::fabs((b[0] - a[0]) * (c[1] - a[1]) -
+                                (c[0] - a[0]) * (b[1] - a[1]));
+    }
+    std::printf("hidden area: eye %d, %d triangles covering %.1f%% of the "
+                "image\n",
+                eye, indexCount / 3, area * 100.);
+}
+
+/// Whether the corners of every eye's view frustum are inside @p frustum.
+static bool enclosesEyes(OSVR_UnityCullingFrustum const &frustum,
+                         OSVR_UnityEyeRenderData const *eyes, int eyeCount) {
+    for (int eye = 0; eye < eyeCount; ++eye) {
+        auto const &p = eyes[eye].projection;
+        auto const &q = eyes[eye].pose.rotation.data;
+        auto const &t = eyes[eye].pose.translation.data;
+        for (int c = 0; c < 8; ++c) {
+            const double s = c < 4 ? 1. : p.farClip / p.nearClip;
+            const double v[3] = {s * ((c & 1) ? p.right : p.left),
+                                 s * ((c & 2) ? p.top : p.bottom),
+                                 -s * p.nearClip};
+            // Rotate by the (w, x, y, z) quaternion, then translate.
+            const double tx = 2. * (q[2] * v[2] - q[3] * v[1]);
+            const double ty = 2. * (q[3] * v[0] - q[1] * v[2]);
+            const double tz = 2. * (q[1] * v[1] - q[2] * v[0]);
+            const double w[3] = {
+                v[0] + q[0] * tx + (q[2] * tz - q[3] * ty) + t[0],
+                v[1] + q[0] * ty + (q[3] * tx - q[1] * tz) + t[1],
+                v[2] + q[0] * tz + (q[1] * ty - q[2] * tx) + t[2]};
+            // The same corner in Unity's world space has z negated.
+            for (int i = 0; i < 6; ++i) {
+                auto const &plane = frustum.planes[i];
+                auto const &unity = frustum.unityPlanes[i];
+                const double tolerance = -1e-9 * (1. + p.farClip);
+                if (plane[0] * w[0] + plane[1] * w[1] + plane[2] * w[2] +
+                            plane[3] <
+                        tolerance ||
+                    unity[0] * w[0] + unity[1] * w[1] - unity[2] * w[2] +
+                            unity[3] <
+                        tolerance) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+/// Checks @p matrices against a plain transformation of a few points by
+/// @p eye's pose and projection: a Unity world point is an OSVR one with z
+/// negated, the view takes it into eye space by the inverse pose, and the
+/// projection must send the corners of the view volume to the corners of
+/// clip space.
+static bool matchesEye(OSVR_UnityEyeMatrices const &matrices,
+                       OSVR_UnityEyeRenderData const &eye, int clipSpace) {
+    auto transform = [](const float *m, const double (&v)[4],
+                        double(&out)[4]) {
+        for (int row = 0; row < 4; ++row) {
+            out[row] = m[row] * v[0] + m[4 + row] * v[1] +
+                       m[8 + row] * v[2] + m[12 + row] * v[3];
+        }
+    };
+    auto close = [](double a, double b) {
+        return std::fabs(a - b) <= 1e-4 * (1. + std::fabs(b));
+    };
+    auto const &q = eye.pose.rotation.data;
+    auto const &t = eye.pose.translation.data;
+    const double points[3][3] = {{0., 0., 0.}, {1., 2., 3.}, {-4., 0.5, -2.}};
+    for (auto const &unity : points) {
+        // Eye space is the inverse pose: rotate by the conjugate quaternion.
+        const double v[3] = {unity[0] - t[0], unity[1] - t[1],
+                             -unity[2] - t[2]};
+        const double tx = 2. * (-q[2] * v[2] + q[3] * v[1]);
+        const double ty = 2. * (-q[3] * v[0] + q[1] * v[2]);
+        const double tz = 2. * (-q[1] * v[1] + q[2] * v[0]);
+        const double expected[3] = {
+            v[0] + q[0] * tx + (-q[2] * tz + q[3] * ty),
+            v[1] + q[0] * ty + (-q[3] * tx + q[1] * tz),
+            v[2] + q[0] * tz + (-q[1] * ty + q[2] * tx)};
+        const double in[4] = {unity[0], unity[1], unity[2], 1.};
+        double out[4];
+        transform(matrices.view, in, out);
+        for (int i = 0; i < 3; ++i) {
+            if (!close(out[i], expected[i])) {
+                return false;
+            }
+        }
+    }
+    auto const &p = eye.projection;
+    const double nearDepth =
+        clipSpace == OSVR_UNITY_CLIP_SPACE_OPENGL
+            ? -1.
+            : clipSpace == OSVR_UNITY_CLIP_SPACE_D3D ? 0. : 1.;
+    const double farDepth =
+        clipSpace == OSVR_UNITY_CLIP_SPACE_D3D_REVERSED_Z ? 0. : 1.;
+    const double scale = p.farClip / p.nearClip;
+    const double corners[2][4] = {
+        {p.left, p.bottom, -p.nearClip, 1.},
+        {scale * p.right, scale * p.top, -p.farClip, 1.}};
+    const double expected[2][3] = {{-1., -1., nearDepth}, {1., 1., farDepth}};
+    for (int c = 0; c < 2; ++c) {
+        double clip[4];
+        transform(matrices.projection, corners[c], clip);
+        for (int i = 0; i < 3; ++i) {
+            if (!close(clip[i] / clip[3], expected[c][i])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool samePose(OSVR_Pose3 const &a, OSVR_Pose3 const &b) {
+    for (int i = 0; i < 3; ++i) {
+        if (std::fabs(a.translation.data[i] - b.translation.data[i]) > 1e-9) {
+            return false;
+        }
+    }
+    for (int i = 0; i < 4; ++i) {
+        if (std::fabs(a.rotation.data[i] - b.rotation.data[i]) > 1e-9) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Pushes the same timestamp twice into a pose history, as when one tracker
+/// report is read twice in a frame: the second pose must replace the first
+/// without dropping the older entries.
+static bool checkRepeatedTimestamp() {
+    OSVR_Pose3 poses[3];
+    for (int i = 0; i < 3; ++i) {
+        poses[i].translation.data[0] = i;
+        poses[i].translation.data[1] = poses[i].translation.data[2] = 0.;
+        poses[i].rotation.data[0] = 1.;
+        poses[i].rotation.data[1] = poses[i].rotation.data[2] =
+            poses[i].rotation.data[3] = 0.;
+    }
+    posehistory::PoseHistory<1> history;
+    history.push(1000, &poses[0], 1);
+    history.push(2000, &poses[1], 1);
+    history.push(2000, &poses[2], 1);
+    OSVR_Pose3 first;
+    OSVR_Pose3 replaced;
+    OSVR_Pose3 between;
+    return history.sample(0, 1000, 0, first) &&
+           samePose(first, poses[0]) &&
+           history.sample(0, 2000, 0, replaced) &&
+           samePose(replaced, poses[2]) &&
+           history.sample(0, 1500, 0, between) &&
+           std::fabs(between.translation.data[0] - 1.) < 1e-9;
+}
+
+/// Angle between the orientations of two poses, in degrees.
+static double angleBetween(OSVR_Pose3 const &a, OSVR_Pose3 const &b) {
+    double dot = 0.;
+    for (int i = 0; i < 4; ++i) {
+        dot += a.rotation.data[i] * b.rotation.data[i];
+    }
+    return 2. * std::acos(std::min(std::fabs(dot), 1.)) * 180. /
+           3.14159265358979323846;
+}
+
+// --------------------------------------------------------------------------
+// Recorded trajectories
+//
+// --record-trajectory saves the eye 0 poses as measured during a run;
+// --replay-trajectory runs the plugin's pose predictor over such a recording
+// offline, so a given recording always gives the same result.
+
+/// One measured eye 0 pose.
+struct TrajectorySample {
+    std::int64_t timeUs;
+    OSVR_Pose3 pose;
+};
+
+/// Velocities are averaged over this much history, as SetPosePrediction
+/// does.
+static const std::int64_t kPredictionWindowUs = 20000;
+
+static std::int64_t toMicroseconds(OSVR_TimeValue const &t) {
+    return static_cast<std::int64_t>(t.seconds) * 1000000 + t.microseconds;
+}
+
+/// One sample per line: microseconds, translation (x, y, z), rotation
+/// (w, x, y, z).
+static bool writeTrajectory(std::string const &path,
+                            std::vector<TrajectorySample> const &samples) {
+    FILE *f = std::fopen(path.c_str(), "w");
+    if (f == nullptr) {
+        return false;
+    }
+    for (auto const &s : samples) {
+        auto const &t = s.pose.translation.data;
+        auto const &q = s.pose.rotation.data;
+        std::fprintf(f, "%lld %.17g %.17g %.17g %.17g %.17g %.17g %.17g\n",
+                     static_cast<long long>(s.timeUs), t[0], t[1], t[2], q[0],
+                     q[1], q[2], q[3]);
+    }
+    return std::fclose(f) == 0;
+}
+
+static bool readTrajectory(std::string const &path,
+                           std::vector<TrajectorySample> &samples) {
+    FILE *f = std::fopen(path.c_str(), "r");
+    if (f == nullptr) {
+        return false;
+    }
+    long long timeUs;
+    TrajectorySample s;
+    auto &t = s.pose.translation.data;
+    auto &q = s.pose.rotation.data;
+    while (std::fscanf(f, "%lld %lf %lf %lf %lf %lf %lf %lf", &timeUs, &t[0],
+                       &t[1], &t[2], &q[0], &q[1], &q[2], &q[3]) == 8) {
+        s.timeUs = timeUs;
+        samples.push_back(s);
+    }
+    const bool ok = std::feof(f) != 0;
+    std::fclose(f);
+    return ok;
+}
+
+/// The recorded pose at @p timeUs, interpolated between the samples around
+/// it. False outside the recording.
+static bool trajectoryPoseAt(std::vector<TrajectorySample> const &samples,
+                             std::int64_t timeUs, OSVR_Pose3 &out) {
+    auto after = std::upper_bound(
+        samples.begin(), samples.end(), timeUs,
+        [](std::int64_t t, TrajectorySample const &s) { return t < s.timeUs; });
+    if (after == samples.begin() || after == samples.end()) {
+        return false;
+    }
+    auto const &a = *(after - 1);
+    auto const &b = *after;
+    out = posehistory::interpolate(
+        a.pose, b.pose,
+        static_cast<double>(timeUs - a.timeUs) / (b.timeUs - a.timeUs));
+    return true;
+}
+
+/// Feeds the recording to a pose history one sample at a time, as the
+/// plugin's render info updates do, predicts each sample @p leadSeconds
+/// ahead with posehistory::predict and compares that with the recorded pose
+/// at that time. Returns false unless prediction beat using the pose as is.
+static bool replayTrajectory(std::vector<TrajectorySample> const &samples,
+                             double leadSeconds) {
+    const auto leadUs = static_cast<std::int64_t>(leadSeconds * 1e6);
+    posehistory::PoseHistory<1> history;
+    double predictedError = 0.;
+    double unpredictedError = 0.;
+    int count = 0;
+    for (auto const &s : samples) {
+        history.push(s.timeUs, &s.pose, 1);
+        OSVR_Pose3 actual;
+        if (s.timeUs - samples.front().timeUs < kPredictionWindowUs ||
+            !trajectoryPoseAt(samples, s.timeUs + leadUs, actual)) {
+            continue;
+        }
+        const OSVR_Pose3 predicted = posehistory::predict(
+            history, 0, s.timeUs, s.pose, kPredictionWindowUs, leadUs);
+        predictedError += angleBetween(predicted, actual);
+        unpredictedError += angleBetween(s.pose, actual);
+        ++count;
+    }
+    if (count == 0) {
+        std::printf("trajectory replay: no samples to check\n");
+        return false;
+    }
+    std::printf("trajectory replay: %d samples, lead %.1f ms, mean error "
+                "%.4f deg (%.4f deg without prediction)\n",
+                count, leadSeconds * 1e3, predictedError / count,
+                unpredictedError / count);
+    return predictedError < unpredictedError;
+}
+
+// --------------------------------------------------------------------------
+// Latency bookkeeping
+
+/// Collects durations for one kind of call; only touched by one thread.
+class LatencyRecorder {
+  public:
+    explicit LatencyRecorder(const char *name) : name_(name) {
+        samples_.reserve(1 << 16);
+    }
+
+    template <typename F> void time(F &&f) {
+        const auto start = Clock::now();
+        f();
+        const auto end = Clock::now();
+        samples_.push_back(
+            std::chrono::duration<double, std::micro>(end - start).count());
+    }
+
+    void report() {
+        if (samples_.empty()) {
+            std::printf("%-22s (no samples)\n", name_);
+            return;
+        }
+        std::sort(samples_.begin(), samples_.end());
+        auto pct = [&](double p) {
+            auto idx = static_cast<std::size_t>(p * (samples_.size() - 1));
+            return samples_[idx];
+        };
+        std::printf("%-22s %9zu %9.2f %9.2f %9.2f %9.2f %9.2f\n", name_,
+                    samples_.size(), pct(0.5), pct(0.9), pct(0.99),
+                    pct(0.999), samples_.back());
+    }
+
+  private:
+    const char *name_;
+    std::vector<double> samples_;
+};
+
+static void printReportHeader() {
+    std::printf("%-22s %9s %9s %9s %9s %9s %9s\n", "latency (us)", "count",
+                "p50", "p90", "p99", "p99.9", "max");
+}
+
+/// Prints one of the plugin's own latency summaries (GetPluginFrameStats).
+static void printPluginLatency(const char *name,
+                               OSVR_UnityLatencySummary const &summary) {
+    std::printf("  %-20s %9llu p50 %7.3f ms, p95 %7.3f ms, p99 %7.3f ms, "
+                "max %7.3f ms\n",
+                name, static_cast<unsigned long long>(summary.count),
+                summary.p50Ms, summary.p95Ms, summary.p99Ms, summary.maxMs);
+}
+
+// --------------------------------------------------------------------------
+
+int main(int argc, char *argv[]) {
+    HostOptions opts;
+    if (!parseOptions(argc, argv, opts)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (opts.posePrediction && opts.checkPoseHistory) {
+        // The published poses are predicted, the history holds measured
+        // ones: they aren't supposed to match.
+        std::printf("--check-pose-history ignored with --pose-prediction\n");
+        opts.checkPoseHistory = false;
+    }
+    const bool repeatedTimestampOk =
+        !opts.checkPoseHistory || checkRepeatedTimestamp();
+    if (opts.checkDistortion) {
+        if (!checkDistortionGolden()) {
+            std::fprintf(stderr, "FAILED: the distortion mesh did not match "
+                                 "the expected texture coordinates\n");
+            return 2;
+        }
+        return 0;
+    }
+    if (!opts.replayTrajectoryPath.empty()) {
+        std::vector<TrajectorySample> trajectory;
+        if (!readTrajectory(opts.replayTrajectoryPath, trajectory)) {
+            std::fprintf(stderr, "Could not read trajectory '%s'\n",
+                         opts.replayTrajectoryPath.c_str());
+            return 1;
+        }
+        if (!replayTrajectory(trajectory, opts.predictionLeadSeconds < 0.
+                                              ? 0.02
+                                              : opts.predictionLeadSeconds)) {
+            std::fprintf(stderr, "FAILED: prediction did not reduce the "
+                                 "error along the trajectory\n");
+            return 2;
+        }
+        return 0;
+    }
+    if (opts.checkGLTextures) {
+        opts.renderer = kUnityGfxRendererOpenGL;
+    }
+    s_hostRenderer = opts.renderer;
+
+    PluginModule module(opts.pluginPath);
+    if (!module) {
+        std::fprintf(stderr, "Could not load plugin '%s'\n",
+                     opts.pluginPath.c_str());
+        return 1;
+    }
+    PluginApi api;
+    if (!api.load(module)) {
+        return 1;
+    }
+
+    api.LinkDebug(&HostDebugLog);
+    // Like Unity, load fires the Initialize device event from inside.
+    api.UnityPluginLoad(&s_hostInterfaces);
+    UnityRenderingEvent renderEvent = api.GetRenderEventFunc();
+    {
+        // What a scene could size its eye textures from before RenderManager
+        // exists.
+        OSVR_UnityEyeRenderData eyes[2];
+        OSVR_UnityRenderDataHeader header = {};
+        const int views = api.GetAllEyeRenderData(eyes, 2, &header);
+        std::printf("at plugin load: %d views%s", views,
+                    header.provisional ? " (provisional)" : "");
+        if (views > 0) {
+            std::printf(", eye 0 viewport %gx%g", eyes[0].viewport.width,
+                        eyes[0].viewport.height);
+        }
+        std::printf("\n");
+    }
+
+    // Texture names as if from Unity's GetNativeTexturePtr(), on OpenGL.
+    // Without a texture array the plugin makes no GL calls of its own and
+    // the mock never draws, so made-up names do.
+    std::uint32_t eyeTextures[2] = {7, 8};
+    const bool setEyeTextures = opts.renderer == kUnityGfxRendererOpenGL;
+    if (opts.useMockBackend) {
+        api.SetRenderBackend(OSVR_UNITY_RENDER_BACKEND_MOCK);
+        api.SetMockRenderBackendRefreshRate(opts.mockRefreshRateHz);
+        api.SetStereoTextureLayout(opts.textureLayout);
+        for (int eye = 0; setEyeTextures && eye < 2; ++eye) {
+            api.SetColorBufferFromUnity(
+                reinterpret_cast<void *>(
+                    static_cast<std::uintptr_t>(eyeTextures[eye])),
+                eye);
+        }
+        if (opts.asyncCreate) {
+            // The render thread below finishes the job.
+            const auto start = Clock::now();
+            const auto ret =
+                api.CreateRenderManagerFromUnityAsync(nullptr, nullptr);
+            std::printf("CreateRenderManagerFromUnityAsync returned after "
+                        "%.1f us\n",
+                        std::chrono::duration<double, std::micro>(
+                            Clock::now() - start)
+                            .count());
+            if (ret != OSVR_RETURN_SUCCESS) {
+                std::fprintf(stderr, "Could not start creating the mock "
+                                     "backend\n");
+                api.UnityPluginUnload();
+                return 1;
+            }
+        } else if (api.CreateRenderManagerFromUnity(nullptr) !=
+                       OSVR_RETURN_SUCCESS ||
+                   api.ConstructRenderBuffers() != OSVR_RETURN_SUCCESS) {
+            std::fprintf(stderr, "Could not set up the mock backend\n");
+            api.UnityPluginUnload();
+            return 1;
+        }
+    }
+    api.SetPresentThreadMode(opts.maxFramesInFlight, opts.queuePolicy);
+    if (opts.timewarp) {
+        api.SetTimewarpThreadMode(1, OSVR_UNITY_THREAD_PRIORITY_HIGH, 0);
+    }
+    api.SetReprojectionFallback(opts.reprojectionFallback ? 1 : 0);
+    api.SetPosePrediction(opts.posePrediction ? 1 : 0,
+                          opts.predictionLeadSeconds);
+
+    LatencyRecorder updateLatency("event Update");
+    LatencyRecorder renderLatency("event Render");
+    LatencyRecorder reconfigureLatency("event Reconfigure");
+    LatencyRecorder resetLatency("device reset");
+    LatencyRecorder distortionLatency("UpdateDistortionMesh");
+    LatencyRecorder poseLatency("GetEyePose");
+    LatencyRecorder projectionLatency("GetProjectionMatrix");
+    LatencyRecorder viewportLatency("GetViewport");
+    LatencyRecorder allEyesLatency("GetAllEyeRenderData");
+    LatencyRecorder cullingFrustumLatency("GetCullingFrustum");
+    LatencyRecorder eyeMatricesLatency("GetEyeMatrices");
+    LatencyRecorder poseAtTimeLatency("GetEyePoseAtTime");
+
+    std::atomic<bool> running{true};
+    std::uint64_t steadyStateFrames = 0;
+
+    // Simulated Unity render thread: an Update then a Render event per frame,
+    // paced to the requested rate.
+    std::thread renderThread([&] {
+        if (opts.contention) {
+            // A writer that never rests, for the getters to contend with.
+            while (running) {
+                updateLatency.time([&] { renderEvent(kOsvrEventID_Update); });
+            }
+            return;
+        }
+        const auto period = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(1. / opts.rateHz));
+        auto next = Clock::now();
+        for (int frame = 0; running; ++frame) {
+            const bool steadyState = frame >= kWarmupFrames;
+            if (opts.skipEvery > 0 && frame > 0 &&
+                frame % opts.skipEvery == 0) {
+                // A hitch on the Unity side: nothing at all this frame.
+                next += period;
+                std::this_thread::sleep_until(next);
+                continue;
+            }
+            updateLatency.time([&] {
+                AllocationCountingScope counting;
+                renderEvent(kOsvrEventID_Update);
+            });
+            const bool skipRender = opts.skipRenderEvery > 0 && frame > 0 &&
+                                    frame % opts.skipRenderEvery == 0;
+            if (opts.renderWorkSeconds > 0.) {
+                std::this_thread::sleep_for(
+                    std::chrono::duration<double>(opts.renderWorkSeconds));
+            }
+            if (!skipRender) {
+                renderLatency.time([&] {
+                    AllocationCountingScope counting;
+                    renderEvent(kOsvrEventID_Render);
+                });
+            }
+            if (opts.reconfigureEvery > 0 && frame > 0 &&
+                frame % opts.reconfigureEvery == 0) {
+                // As if Unity had recreated the eye 1 RenderTexture. The
+                // null renderer never dereferences it, nor does OpenGL.
+                eyeTextures[1] = static_cast<std::uint32_t>(0x1000 + frame);
+                api.SetColorBufferFromUnity(
+                    reinterpret_cast<void *>(
+                        static_cast<std::uintptr_t>(eyeTextures[1])),
+                    1);
+                reconfigureLatency.time(
+                    [&] { renderEvent(kOsvrEventID_Reconfigure); });
+            }
+            if (opts.resetEvery > 0 && frame > 0 &&
+                frame % opts.resetEvery == 0 &&
+                s_deviceEventCallback != nullptr) {
+                // Unity sends these on the render thread, around e.g. a
+                // D3D9-style device reset or a window mode change.
+                resetLatency.time([&] {
+                    s_deviceEventCallback(kUnityGfxDeviceEventBeforeReset);
+                    s_deviceEventCallback(kUnityGfxDeviceEventAfterReset);
+                });
+            }
+            if (!steadyState) {
+                // Don't count the warm-up frames.
+                s_allocationCount = 0;
+            } else {
+                ++steadyStateFrames;
+            }
+            next += period;
+            std::this_thread::sleep_until(next);
+        }
+    });
+
+    if (opts.useMockBackend && opts.asyncCreate) {
+        // Like a loading screen polling once per frame.
+        const auto start = Clock::now();
+        char reason[128];
+        int status;
+        while ((status = api.GetRenderManagerStatus(reason, sizeof(reason))) ==
+               OSVR_UNITY_RENDER_MANAGER_PENDING) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::printf("RenderManager status %d after %.1f ms%s%s\n", status,
+                    std::chrono::duration<double, std::milli>(Clock::now() -
+                                                              start)
+                        .count(),
+                    status == OSVR_UNITY_RENDER_MANAGER_FAILED ? ": " : "",
+                    status == OSVR_UNITY_RENDER_MANAGER_FAILED ? reason : "");
+        // Like a scene that sets up its eye textures once RenderManager is
+        // ready.
+        if (status == OSVR_UNITY_RENDER_MANAGER_READY &&
+            api.ConstructRenderBuffers() != OSVR_RETURN_SUCCESS) {
+            std::fprintf(stderr, "Could not construct the render buffers\n");
+        }
+    }
+
+    if (opts.distortionBenchmarkRuns > 0) {
+        // A made-up lens that leaves the image corners unseen, with a
+        // little lateral chromatic aberration: red spreads most, blue least.
+        const float red[] = {0.f, 0.90f, 0.f, -0.30f, 0.f, 0.05f};
+        const float green[] = {0.f, 0.88f, 0.f, -0.31f, 0.f, 0.05f};
+        const float blue[] = {0.f, 0.86f, 0.f, -0.32f, 0.f, 0.05f};
+        OSVR_UnityDistortionParameters distortion[2];
+        for (int eye = 0; eye < 2; ++eye) {
+            auto &d = distortion[eye];
+            d.centerOfProjection[0] = eye == 0 ? 0.55f : 0.45f;
+            d.centerOfProjection[1] = 0.5f;
+            d.distanceScale[0] = d.distanceScale[1] = 1.f;
+            d.polynomial[0] = red;
+            d.polynomial[1] = green;
+            d.polynomial[2] = blue;
+            d.polynomialLength[0] = d.polynomialLength[1] =
+                d.polynomialLength[2] = 6;
+        }
+        api.SetDistortionMeshCache(opts.distortionCache ? 1 : 0);
+        // Without the cache each call generates the meshes, starting one
+        // thread per eye and color, which is what the 1 ms target covers.
+        std::printf("distortion benchmark: %d triangles per eye, %s (target: "
+                    "under 1000 us per call)\n",
+                    opts.distortionTriangles,
+                    opts.distortionCache
+                        ? "cached meshes"
+                        : "generated each call, thread startup included");
+        for (int i = 0; i < opts.distortionBenchmarkRuns; ++i) {
+            distortionLatency.time([&] {
+                if (api.UpdateDistortionMesh(distortion, 2,
+                                             opts.distortionTriangles) !=
+                    OSVR_RETURN_SUCCESS) {
+                    std::fprintf(stderr, "UpdateDistortionMesh failed\n");
+                }
+            });
+        }
+    }
+
+    if (opts.distortionBenchmarkRuns > 0) {
+        for (int eye = 0; eye < 2; ++eye) {
+            printHiddenArea(api, eye);
+        }
+    }
+
+    // Simulated Unity main thread: the per-eye getters, as fast as possible.
+    const auto end =
+        Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                           std::chrono::duration<double>(opts.durationSeconds));
+    OSVR_UnityEyeRenderData eyes[2];
+    OSVR_UnityRenderDataHeader header;
+    OSVR_UnityCullingFrustum cullingFrustum;
+    std::uint64_t cullingFrustumsChecked = 0;
+    std::uint64_t cullingFrustumsFailed = 0;
+    OSVR_UnityEyeMatrices matrices[2];
+    OSVR_UnityRenderDataHeader matricesHeader;
+    int clipSpace = OSVR_UNITY_CLIP_SPACE_OPENGL;
+    std::uint64_t eyeMatricesChecked = 0;
+    std::uint64_t eyeMatricesFailed = 0;
+    std::uint64_t posesAtTimeChecked = 0;
+    std::uint64_t posesAtTimeFailed = 0;
+    std::vector<TrajectorySample> trajectory;
+    trajectory.reserve(1 << 16);
+    std::uint64_t lastTrajectoryGeneration = 0;
+    while (Clock::now() < end) {
+        if (!opts.runGetters) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+        for (int eye = 0; eye < 2; ++eye) {
+            poseLatency.time([&] { api.GetEyePose(eye); });
+            projectionLatency.time([&] { api.GetProjectionMatrix(eye); });
+            viewportLatency.time([&] { api.GetViewport(eye); });
+        }
+        allEyesLatency.time(
+            [&] { api.GetAllEyeRenderData(eyes, 2, &header); });
+        OSVR_ReturnCode frustumRet = OSVR_RETURN_FAILURE;
+        cullingFrustumLatency.time(
+            [&] { frustumRet = api.GetCullingFrustum(&cullingFrustum); });
+        if (opts.checkCullingFrustum && frustumRet == OSVR_RETURN_SUCCESS &&
+            cullingFrustum.generation == header.generation) {
+            ++cullingFrustumsChecked;
+            if (!enclosesEyes(cullingFrustum, eyes,
+                              std::min(header.eyeCount, 2))) {
+                ++cullingFrustumsFailed;
+            }
+        }
+        eyeMatricesLatency.time([&] {
+            api.GetEyeMatrices(matrices, 2, clipSpace, &matricesHeader);
+        });
+        if (opts.checkEyeMatrices &&
+            matricesHeader.generation == header.generation) {
+            for (int eye = 0; eye < std::min(header.eyeCount, 2); ++eye) {
+                ++eyeMatricesChecked;
+                if (!matchesEye(matrices[eye], eyes[eye], clipSpace)) {
+                    ++eyeMatricesFailed;
+                }
+            }
+            // Try each convention in turn.
+            clipSpace = (clipSpace + 1) % 3;
+        }
+        // Like a physics step a few milliseconds back.
+        OSVR_TimeValue past = header.timestamp;
+        past.microseconds -= 5000;
+        if (past.microseconds < 0) {
+            past.microseconds += 1000000;
+            --past.seconds;
+        }
+        OSVR_Pose3 pose;
+        poseAtTimeLatency.time([&] { api.GetEyePoseAtTime(0, past, &pose); });
+        if (opts.checkPoseHistory && header.eyeCount > 0 &&
+            !header.provisional) {
+            ++posesAtTimeChecked;
+            if (api.GetEyePoseAtTime(0, header.timestamp, &pose) !=
+                    OSVR_RETURN_SUCCESS ||
+                !samePose(pose, eyes[0].pose)) {
+                ++posesAtTimeFailed;
+            }
+        }
+        if (!opts.recordTrajectoryPath.empty() && header.eyeCount > 0 &&
+            !header.provisional &&
+            header.generation != lastTrajectoryGeneration) {
+            // The history has the pose as measured, even when the
+            // published one is predicted.
+            lastTrajectoryGeneration = header.generation;
+            TrajectorySample sample;
+            sample.timeUs = toMicroseconds(header.timestamp);
+            if (api.GetEyePoseAtTime(0, header.timestamp, &sample.pose) ==
+                OSVR_RETURN_SUCCESS) {
+                trajectory.push_back(sample);
+            }
+        }
+    }
+    running = false;
+    renderThread.join();
+
+    renderEvent(kOsvrEventID_Shutdown);
+    if (!opts.tracePath.empty() &&
+        api.WriteFrameTrace(opts.tracePath.c_str(), opts.durationSeconds) !=
+            OSVR_RETURN_SUCCESS) {
+        std::fprintf(stderr, "Could not write the frame trace\n");
+    }
+    OSVR_UnityPresentQueueStats queueStats;
+    api.GetPresentQueueStats(&queueStats);
+    OSVR_UnityPluginFrameStats frameStats;
+    api.GetPluginFrameStats(&frameStats);
+    OSVR_UnityTimewarpStats timewarpStats;
+    api.GetTimewarpStats(&timewarpStats);
+    OSVR_UnityMockRenderBackendStats mockStats;
+    const bool haveMockStats =
+        api.GetMockRenderBackendStats(&mockStats) == OSVR_RETURN_SUCCESS;
+    api.ShutdownRenderManager();
+    api.UnityPluginUnload();
+
+    if (opts.maxFramesInFlight > 0) {
+        std::printf("present thread: %llu frames queued, %llu presented, "
+                    "%llu dropped, %d in flight\n",
+                    static_cast<unsigned long long>(queueStats.framesEnqueued),
+                    static_cast<unsigned long long>(queueStats.framesPresented),
+                    static_cast<unsigned long long>(queueStats.framesDropped),
+                    queueStats.queueDepth);
+    }
+    if (opts.timewarp || opts.reprojectionFallback) {
+        std::printf("timewarp: %llu fresh frames, %llu reprojected\n",
+                    static_cast<unsigned long long>(timewarpStats.framesFresh),
+                    static_cast<unsigned long long>(
+                        timewarpStats.framesReprojected));
+    }
+    if (haveMockStats) {
+        std::printf("mock backend: %llu frames presented, %d buffers "
+                    "registered (%llu times), %d buffers and %d cropping "
+                    "viewports in last present\n",
+                    static_cast<unsigned long long>(mockStats.presentCount),
+                    mockStats.registeredBufferCount,
+                    static_cast<unsigned long long>(mockStats.registerCount),
+                    mockStats.lastPresentedBufferCount,
+                    mockStats.lastCroppingViewportCount);
+    }
+
+    std::printf("plugin: %llu render events, %llu frames presented, %llu "
+                "present failures, %llu updates skipped\n",
+                static_cast<unsigned long long>(frameStats.renderEvents),
+                static_cast<unsigned long long>(frameStats.framesPresented),
+                static_cast<unsigned long long>(frameStats.presentFailures),
+                static_cast<unsigned long long>(frameStats.updatesSkipped));
+    printPluginLatency("present duration", frameStats.presentDuration);
+    printPluginLatency("pose age at present", frameStats.poseAgeAtPresent);
+    printPluginLatency("update to render", frameStats.updateToRender);
+    if (opts.posePrediction) {
+        std::printf("pose prediction: last lead %.1f ms\n",
+                    frameStats.predictionLeadSeconds * 1e3);
+    }
+    if (!opts.recordTrajectoryPath.empty()) {
+        if (!writeTrajectory(opts.recordTrajectoryPath, trajectory)) {
+            std::fprintf(stderr, "Could not write trajectory '%s'\n",
+                         opts.recordTrajectoryPath.c_str());
+            return 1;
+        }
+        std::printf("trajectory: %zu poses recorded\n", trajectory.size());
+    }
+
+    const std::uint64_t allocations = s_allocationCount;
+    std::printf("render thread: %llu heap allocations in %llu steady-state "
+                "frames\n",
+                static_cast<unsigned long long>(allocations),
+                static_cast<unsigned long long>(steadyStateFrames));
+
+    printReportHeader();
+    updateLatency.report();
+    renderLatency.report();
+    if (opts.reconfigureEvery > 0) {
+        reconfigureLatency.report();
+    }
+    if (opts.resetEvery > 0) {
+        resetLatency.report();
+    }
+    if (opts.distortionBenchmarkRuns > 0) {
+        distortionLatency.report();
+    }
+    poseLatency.report();
+    projectionLatency.report();
+    viewportLatency.report();
+    allEyesLatency.report();
+    cullingFrustumLatency.report();
+    eyeMatricesLatency.report();
+    poseAtTimeLatency.report();
+    if (opts.checkCullingFrustum) {
+        std::printf("culling frustum: %llu checked, %llu not enclosing the "
+                    "eyes\n",
+                    static_cast<unsigned long long>(cullingFrustumsChecked),
+                    static_cast<unsigned long long>(cullingFrustumsFailed));
+        if (cullingFrustumsChecked == 0 || cullingFrustumsFailed != 0) {
+            std::fprintf(stderr, "FAILED: the culling frustum did not "
+                                 "enclose the eye frusta\n");
+            return 2;
+        }
+    }
+    if (opts.checkEyeMatrices) {
+        std::printf("eye matrices: %llu checked, %llu wrong\n",
+                    static_cast<unsigned long long>(eyeMatricesChecked),
+                    static_cast<unsigned long long>(eyeMatricesFailed));
+        if (eyeMatricesChecked == 0 || eyeMatricesFailed != 0) {
+            std::fprintf(stderr, "FAILED: GetEyeMatrices disagreed with "
+                                 "the poses and projections\n");
+            return 2;
+        }
+    }
+    if (opts.checkPoseHistory) {
+        std::printf("pose history: %llu checked, %llu wrong\n",
+                    static_cast<unsigned long long>(posesAtTimeChecked),
+                    static_cast<unsigned long long>(posesAtTimeFailed));
+        if (posesAtTimeChecked == 0 || posesAtTimeFailed != 0) {
+            std::fprintf(stderr, "FAILED: GetEyePoseAtTime disagreed with "
+                                 "the latest poses\n");
+            return 2;
+        }
+        std::printf("pose history: repeated timestamp %s\n",
+                    repeatedTimestampOk ? "replaced the pose" : "WRONG");
+        if (!repeatedTimestampOk) {
+            std::fprintf(stderr, "FAILED: a repeated timestamp did not "
+                                 "replace the newest pose\n");
+            return 2;
+        }
+    }
+    if (opts.checkGLTextures) {
+        bool same = haveMockStats && mockStats.registeredBufferCount == 2;
+        for (int eye = 0; same && eye < 2; ++eye) {
+            // Side by side, both eyes present from the texture for eye 0.
+            const auto expected =
+                eyeTextures[opts.textureLayout ==
+                                    OSVR_UNITY_STEREO_TEXTURE_PER_EYE
+                                ? eye
+                                : 0];
+            same = mockStats.registeredTextureNames[eye] == expected;
+        }
+        std::printf("gl textures: registered %u and %u for %u and %u\n",
+                    haveMockStats ? mockStats.registeredTextureNames[0] : 0u,
+                    haveMockStats ? mockStats.registeredTextureNames[1] : 0u,
+                    eyeTextures[0], eyeTextures[1]);
+        if (!same) {
+            std::fprintf(stderr, "FAILED: the registered texture names "
+                                 "differ from those set from Unity\n");
+            return 2;
+        }
+    }
+    if (opts.checkAllocations && allocations != 0) {
+        std::fprintf(stderr, "FAILED: the plugin allocated on the render "
+                             "thread in steady state\n");
+        return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,226 @@
+/** @file
+    @brief Header
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Sensics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_MockRenderBackend_h_GUID_C81F4A06_2B5D_4E97_A3C8_7E19D6F05B2C
+#define INCLUDED_MockRenderBackend_h_GUID_C81F4A06_2B5D_4E97_A3C8_7E19D6F05B2C
+
+// Internal Includes
+#include "PluginConfig.h"
+#include "RenderBackend.h"
+
+// Library/third-party includes
+#if SUPPORT_OPENGL && (UNITY_WIN || UNITY_LINUX)
+#include <GL/glew.h>
+
+#include <osvr/RenderKit/GraphicsLibraryOpenGL.h>
+#endif
+
+// Standard includes
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+
+/// A RenderBackend that needs neither an OSVR server nor a GPU: it reports a
+/// fixed two-eye display, moves the head along a scripted trajectory, blocks
+/// in PresentRenderBuffers until the next simulated vsync, and counts what
+/// it's asked to present.
+///
+/// Like RenderManager, it's called from the render thread or the plugin's
+/// present and timewarp threads, but never concurrently: the plugin
+/// serializes every call. The counters may be read from any thread.
+class MockRenderBackend : public RenderBackend {
+  public:
+    typedef std::chrono::steady_clock Clock;
+
+    /// @param library Passed back in each RenderInfo, like RenderManager.
+    /// @param refreshRateHz Simulated display rate; 0 presents without waiting.
+    explicit MockRenderBackend(osvr::renderkit::GraphicsLibrary library,
+                               double refreshRateHz = 90.)
+        : library_(library), start_(Clock::now()) {
+        if (refreshRateHz > 0.) {
+            vsyncPeriod_ = std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(1. / refreshRateHz));
+        }
+    }
+
+    static const int kEyeWidth = 1080;
+    static const int kEyeHeight = 1200;
+    static const std::size_t kMaxTextureNames = 8;
+
+    bool doingOkay() override { return true; }
+
+    RenderManager::OpenResults OpenDisplay() override {
+        RenderManager::OpenResults ret;
+        ret.status = RenderManager::OpenStatus::COMPLETE;
+        ret.library = library_;
+        return ret;
+    }
+
+    void GetRenderInfo(const RenderManager::RenderParams &params,
+                       std::vector<RenderInfo> &ret) override {
+        ret.resize(2);
+        const double t = std::chrono::duration<double>(Clock::now() - start_)
+                             .count();
+        // Scripted head motion: a slow side-to-side look (yaw) with a little
+        // vertical bob, like someone scanning a room.
+        const double pi = 3.14159265358979323846;
+        const double yaw = 0.5 * std::sin(2. * pi * 0.25 * t);
+        const double bob = 0.01 * std::sin(2. * pi * 1.5 * t);
+        const double headHeight = 1.7;
+        // Symmetric 90 degree field of view per eye.
+        const double halfExtent = params.nearClipDistanceMeters;
+        for (int eye = 0; eye < 2; ++eye) {
+            RenderInfo &ri = ret[eye];
+            ri.library = library_;
+            ri.viewport.left = 0;
+            ri.viewport.lower = 0;
+            ri.viewport.width = kEyeWidth;
+            ri.viewport.height = kEyeHeight;
+
+            // Eyes sit +/- half the IPD along the head's x axis, which is
+            // rotated by the yaw about +y.
+            const double dx = (eye == 0 ? -0.5 : 0.5) * params.IPDMeters;
+            ri.pose.translation.data[0] = std::cos(yaw) * dx;
+            ri.pose.translation.data[1] = headHeight + bob;
+            ri.pose.translation.data[2] = -std::sin(yaw) * dx;
+            ri.pose.rotation.data[0] = std::cos(yaw / 2.); // w
+            ri.pose.rotation.data[1] = 0.;
+            ri.pose.rotation.data[2] = std::sin(yaw / 2.);
+            ri.pose.rotation.data[3] = 0.;
+
+            ri.projection.left = -halfExtent;
+            ri.projection.right = halfExtent;
+            ri.projection.bottom = -halfExtent;
+            ri.projection.top = halfExtent;
+            ri.projection.nearClip = params.nearClipDistanceMeters;
+            ri.projection.farClip = params.farClipDistanceMeters;
+        }
+    }
+
+    bool
+    RegisterRenderBuffers(const std::vector<RenderBuffer> &buffers) override {
+        registeredBuffers_ = buffers.size();
+        for (std::size_t i = 0; i < registeredTextureNames_.size(); ++i) {
+            std::uint32_t name = 0;
+#if SUPPORT_OPENGL && (UNITY_WIN || UNITY_LINUX)
+            if (i < buffers.size() && buffers[i].OpenGL != nullptr) {
+                name = buffers[i].OpenGL->colorBufferName;
+            }
+#endif
+            registeredTextureNames_[i] = name;
+        }
+        ++registerCount_;
+        return true;
+    }
+
+    bool PresentRenderBuffers(const std::vector<RenderBuffer> &buffers,
+                              const std::vector<RenderInfo> &,
+                              const RenderManager::RenderParams &,
+                              const std::vector<ViewportDescription>
+                                  &normalizedCroppingViewports,
+                              bool) override {
+        waitForVsync();
+        lastPresentedBuffers_ = buffers.size();
+        lastCroppingViewports_ = normalizedCroppingViewports.size();
+        ++presentCount_;
+        return true;
+    }
+
+    bool GetTimingInfo(std::size_t, RenderTimingInfo &info) override {
+        if (vsyncPeriod_ == Clock::duration::zero()) {
+            return false;
+        }
+        const auto sinceVsync = (Clock::now() - start_) % vsyncPeriod_;
+        info.hardwareDisplayInterval = toTimeValue(vsyncPeriod_);
+        info.timeSincelastVerticalRetrace = toTimeValue(sinceVsync);
+        info.timeUntilNextPresentRequired =
+            toTimeValue(vsyncPeriod_ - sinceVsync);
+        return true;
+    }
+
+    bool UpdateDistortionMeshes(
+        RenderManager::DistortionMeshType,
+        std::vector<RenderManager::DistortionParameters> const &) override {
+        return true;
+    }
+    void SetRoomRotationUsingHead() override {}
+    void ClearRoomToWorldTransform() override {}
+
+    /// @name Present bookkeeping
+    /// @{
+    std::uint64_t presentCount() const { return presentCount_; }
+    std::size_t registeredBufferCount() const { return registeredBuffers_; }
+    std::uint64_t registerCount() const { return registerCount_; }
+    /// OpenGL texture name of registered buffer @p i, or 0 if it has none
+    /// (or @p i is past the first kMaxTextureNames).
+    std::uint32_t registeredTextureName(std::size_t i) const {
+        return i < registeredTextureNames_.size()
+                   ? registeredTextureNames_[i].load()
+                   : 0;
+    }
+    std::size_t lastPresentedBufferCount() const {
+        return lastPresentedBuffers_;
+    }
+    std::size_t lastCroppingViewportCount() const {
+        return lastCroppingViewports_;
+    }
+    /// @}
+
+  private:
+    static OSVR_TimeValue toTimeValue(Clock::duration d) {
+        const auto us =
+            std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+        OSVR_TimeValue ret;
+        ret.seconds = static_cast<OSVR_TimeValue_Seconds>(us / 1000000);
+        ret.microseconds =
+            static_cast<OSVR_TimeValue_Microseconds>(us % 1000000);
+        return ret;
+    }
+
+    void waitForVsync() {
+        if (vsyncPeriod_ == Clock::duration::zero()) {
+            return;
+        }
+        const auto sinceStart = Clock::now() - start_;
+        const auto nextVsync = start_ + (sinceStart / vsyncPeriod_ + 1) *
+                                            vsyncPeriod_;
+        std::this_thread::sleep_until(nextVsync);
+    }
+
+    osvr::renderkit::GraphicsLibrary library_;
+    Clock::time_point start_;
+    Clock::duration vsyncPeriod_ = Clock::duration::zero();
+    std::atomic<std::uint64_t> presentCount_{0};
+    std::atomic<std::size_t> registeredBuffers_{0};
+    std::atomic<std::uint64_t> registerCount_{0};
+    std::array<std::atomic<std::uint32_t>, kMaxTextureNames>
+        registeredTextureNames_{};
+    std::atomic<std::size_t> lastPresentedBuffers_{0};
+    std::atomic<std::size_t> lastCroppingViewports_{0};
+};
+
+#endif // INCLUDED_MockRenderBackend_h_GUID_C81F4A06_2B5D_4E97_A3C8_7E19D6F05B2C
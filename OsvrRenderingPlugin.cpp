@@ -26,6 +26,20 @@ Sensics, Inc.
 
 // Internal includes
 #include "OsvrRenderingPlugin.h"
+#include "BufferSetRing.h"
+#include "CullingFrustum.h"
+#include "DistortionMesh.h"
+#include "DistortionMeshCache.h"
+#include "EyeMatrices.h"
+#include "FrameQueue.h"
+#include "FrameStats.h"
+#include "FrameTrace.h"
+#include "MockRenderBackend.h"
+#include "PoseHistory.h"
+#include "RenderBackend.h"
+#include "RenderInfoCache.h"
+#include "SeqLock.h"
+#include "ThreadPriority.h"
 #include "Unity/IUnityGraphics.h"
 #include "UnityRendererType.h"
 
@@ -33,6 +47,7 @@ Sensics, Inc.
 #include "osvr/RenderKit/RenderManager.h"
 #include <osvr/ClientKit/Context.h>
 #include <osvr/ClientKit/Interface.h>
+#include <osvr/ClientKit/ParametersC.h>
 #include <osvr/Util/Finally.h>
 #include <osvr/Util/MatrixConventionsC.h>
 
@@ -41,7 +56,17 @@ Sensics, Inc.
 #include <fstream>
 #include <iostream>
 #endif
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <exception>
 #include <memory>
+#include <mutex>
+#include <thread>
 
 #if UNITY_WIN
 #define NO_MINMAX
@@ -73,20 +98,63 @@ Sensics, Inc.
 #endif //
 #endif // SUPPORT_OPENGL
 
+/// Upper bound on the number of views (eyes) we keep render info for.
+static const std::size_t kMaxViews = 8;
+
+/// Fixed-capacity copy of the most recent render info, published to readers
+/// through a SeqLock so the Unity main thread never waits on the render thread.
+struct RenderInfoSnapshot {
+    std::uint64_t generation;
+    OSVR_TimeValue timestamp;
+    std::size_t count;
+    /// Viewports and projections from the warm-start cache, not (yet) from
+    /// RenderManager.
+    bool provisional;
+    std::array<osvr::renderkit::RenderInfo, kMaxViews> info;
+    /// Encloses the frusta of all views; only valid if hasCullingFrustum.
+    bool hasCullingFrustum;
+    cullingfrustum::Frustum cullingFrustum;
+};
+
 // VARIABLES
 static IUnityInterfaces *s_UnityInterfaces = nullptr;
 static IUnityGraphics *s_Graphics = nullptr;
 static UnityRendererType s_deviceType = {};
 
 static osvr::renderkit::RenderManager::RenderParams s_renderParams;
-static osvr::renderkit::RenderManager *s_render = nullptr;
+static RenderBackend *s_render = nullptr;
+/// Whether s_render is set, for threads that only need to know that and
+/// shouldn't wait out a present on s_renderMutex to find out. Changed
+/// together with s_render, under s_renderMutex.
+static std::atomic<bool> s_renderAvailable{false};
+/// Which RenderBackend CreateRenderManagerFromUnity will create.
+static OSVR_UnityRenderBackend s_backendType =
+    OSVR_UNITY_RENDER_BACKEND_RENDERMANAGER;
+static double s_mockRefreshRateHz = 90.;
 static OSVR_ClientContext s_clientContext = nullptr;
 static std::vector<osvr::renderkit::RenderBuffer> s_renderBuffers;
 static std::vector<osvr::renderkit::RenderInfo> s_renderInfo;
-static std::vector<osvr::renderkit::RenderInfo> s_lastRenderInfo;
+static SeqLock<RenderInfoSnapshot> s_lastRenderInfo;
+/// Render-thread-owned copies of s_lastRenderInfo used for presenting.
+static RenderInfoSnapshot s_presentSnapshot;
+static std::vector<osvr::renderkit::RenderInfo> s_presentRenderInfo;
+/// Constant arguments for PresentRenderBuffers, so that presenting a frame
+/// doesn't construct any temporaries.
+static const osvr::renderkit::RenderManager::RenderParams s_presentParams;
+/// Which part of its buffer each eye presents, in normalized coordinates;
+/// empty (whole buffer) unless side-by-side. Set in ConstructRenderBuffers.
+static std::vector<osvr::renderkit::OSVR_ViewportDescription>
+    s_croppingViewports;
 static osvr::renderkit::GraphicsLibrary s_library;
-static void *s_leftEyeTexturePtr = nullptr;
-static void *s_rightEyeTexturePtr = nullptr;
+/// Unity's native texture for each view, indexed by view (eye) id, as set
+/// with SetColorBufferFromUnity.
+static std::array<void *, kMaxViews> s_viewTextures = {};
+/// Layout requested with SetStereoTextureLayout, and the one the buffers
+/// were last constructed with.
+static OSVR_UnityStereoTextureLayout s_requestedTextureLayout =
+    OSVR_UNITY_STEREO_TEXTURE_PER_EYE;
+static OSVR_UnityStereoTextureLayout s_textureLayout =
+    OSVR_UNITY_STEREO_TEXTURE_PER_EYE;
 /// @todo is this redundant? (given renderParams)
 static double s_nearClipDistance = 0.1;
 /// @todo is this redundant? (given renderParams)
@@ -105,11 +173,6 @@ static std::streambuf *s_oldCerr = nullptr;
 static D3D11_TEXTURE2D_DESC s_textureDesc;
 #endif // SUPPORT_D3D11
 
-// OpenGL vars
-#if SUPPORT_OPENGL
-GLuint s_frameBuffer;
-#endif // SUPPORT_OPENGL
-
 // RenderEvents
 // Called from Unity with GL.IssuePluginEvent
 enum RenderEvents {
@@ -117,11 +180,42 @@ enum RenderEvents {
     kOsvrEventID_Shutdown = 1,
     kOsvrEventID_Update = 2,
     kOsvrEventID_SetRoomRotationUsingHead = 3,
-    kOsvrEventID_ClearRoomToWorldTransform = 4
+    kOsvrEventID_ClearRoomToWorldTransform = 4,
+    /// Rebuild the render buffers that no longer match the render info or eye
+    /// textures, without recreating RenderManager.
+    kOsvrEventID_Reconfigure = 5
 };
 
-// Mutex provides thread safety when accessing s_lastRenderInfo from Unity
-std::mutex m_mutex;
+// Serializes writers of s_renderInfo/s_lastRenderInfo (UpdateRenderInfo can be
+// reached from both the Unity main thread and the render thread). Readers of
+// s_lastRenderInfo never take it.
+static std::mutex s_renderInfoWriteMutex;
+static std::uint64_t s_renderInfoGeneration = 0;
+
+// Serializes every call into s_render, whichever thread it's from, since
+// RenderManager isn't thread-safe. Taken after s_renderInfoWriteMutex when
+// both are needed.
+static std::mutex s_renderMutex;
+
+// Frame statistics, see GetPluginFrameStats. Written from the render and
+// present threads with atomics only, so polling them never stalls a frame.
+static std::atomic<std::uint64_t> s_statFramesPresented{0};
+static std::atomic<std::uint64_t> s_statPresentFailures{0};
+static std::atomic<std::uint64_t> s_statRenderEvents{0};
+static std::atomic<std::uint64_t> s_statUpdatesSkipped{0};
+/// Presents of old buffers by the timewarp thread (also counted above).
+static std::atomic<std::uint64_t> s_statFramesReprojected{0};
+static LatencyHistogram s_presentDurationHistogram;
+static LatencyHistogram s_poseAgeAtPresentHistogram;
+static LatencyHistogram s_updateToRenderHistogram;
+/// steady_clock time of the last kOsvrEventID_Update, in ns (0 if none yet).
+static std::atomic<std::int64_t> s_lastUpdateEventNs{0};
+
+/// Hash of the /display configuration of the current client context, see
+/// RenderInfoCache.h; 0 if unknown.
+static std::uint64_t s_displayConfigKey = 0;
+/// Display key of the warm-start cache loaded at plugin load.
+static std::uint64_t s_warmStartDisplayKey = 0;
 
 // --------------------------------------------------------------------------
 // Helper utilities
@@ -145,13 +239,23 @@ inline void DebugLog(const char *str) {
 #endif // defined(ENABLE_LOGGING) && defined(ENABLE_LOGFILE)
 }
 
+inline void StopPresentThread();
+inline void CancelCreateRenderManagerAsync();
+
 void UNITY_INTERFACE_API ShutdownRenderManager() {
     DebugLog("[OSVR Rendering Plugin] Shutting down RenderManager.");
+    CancelCreateRenderManagerAsync();
+    // The present thread uses s_render, so it has to go first.
+    StopPresentThread();
     if (s_render != nullptr) {
-        delete s_render;
-        s_render = nullptr;
-        s_rightEyeTexturePtr = nullptr;
-        s_leftEyeTexturePtr = nullptr;
+        {
+            // Other threads may still call GetMockRenderBackendStats.
+            std::lock_guard<std::mutex> lock(s_renderMutex);
+            delete s_render;
+            s_render = nullptr;
+            s_renderAvailable = false;
+        }
+        s_viewTextures.fill(nullptr);
     }
     s_clientContext = nullptr;
 }
@@ -199,7 +303,6 @@ inline void DoEventGraphicsDeviceD3D11(UnityGfxDeviceEventType eventType) {
 #if SUPPORT_OPENGL
 // -------------------------------------------------------------------
 /// OpenGL setup/teardown code
-/// @todo OpenGL path not implemented yet
 inline void DoEventGraphicsDeviceOpenGL(UnityGfxDeviceEventType eventType) {
     BOOST_ASSERT_MSG(
         s_deviceType,
@@ -238,12 +341,18 @@ inline void dispatchEventToRenderer(UnityRendererType renderer,
         DoEventGraphicsDeviceOpenGL(eventType);
         break;
 #endif
+    case OSVRSupportedRenderers::Null:
+        // No device-bound state to set up or tear down.
+        break;
     case OSVRSupportedRenderers::EmptyRenderer:
     default:
         break;
     }
 }
 
+inline void ReleaseRenderBuffersForReset();
+inline void RestoreRenderBuffersAfterReset();
+
 /// Needs the calling convention, even though it's static and not exported,
 /// because it's registered as a callback on plugin load.
 static void UNITY_INTERFACE_API
@@ -273,12 +382,14 @@ OnGraphicsDeviceEvent(UnityGfxDeviceEventType eventType) {
     case kUnityGfxDeviceEventBeforeReset: {
         DebugLog(
             "[OSVR Rendering Plugin] OnGraphicsDeviceEvent(BeforeReset).\n");
+        ReleaseRenderBuffersForReset();
         break;
     }
 
     case kUnityGfxDeviceEventAfterReset: {
         DebugLog(
             "[OSVR Rendering Plugin] OnGraphicsDeviceEvent(AfterReset).\n");
+        RestoreRenderBuffersAfterReset();
         break;
     }
     }
@@ -286,6 +397,99 @@ OnGraphicsDeviceEvent(UnityGfxDeviceEventType eventType) {
     dispatchEventToRenderer(s_deviceType, eventType);
 }
 
+// --------------------------------------------------------------------------
+// Warm-start cache
+
+/// Publishes the viewports and projections cached by the last run as
+/// provisional render info, so Unity can size its eye textures and set up
+/// its cameras while RenderManager is still starting.
+inline void LoadWarmStartCache() {
+    renderinfocache::CachedView views[renderinfocache::kMaxViews];
+    const auto n = std::min(
+        renderinfocache::load(renderinfocache::defaultPath(),
+                              s_warmStartDisplayKey, views),
+        kMaxViews);
+    if (n == 0) {
+        return;
+    }
+    RenderInfoSnapshot snapshot = {};
+    snapshot.count = n;
+    snapshot.provisional = true;
+    for (std::size_t i = 0; i < n; ++i) {
+        snapshot.info[i].viewport = views[i].viewport;
+        snapshot.info[i].projection = views[i].projection;
+        snapshot.info[i].pose.rotation.data[0] = 1.; // identity
+    }
+    s_lastRenderInfo.store(snapshot);
+    DebugLog("[OSVR Rendering Plugin] Loaded provisional render info from "
+             "the warm-start cache.");
+}
+
+/// Identifies the display configuration, so a cache written for another
+/// display can be told apart.
+inline std::uint64_t GetDisplayConfigKey(OSVR_ClientContext context) {
+    std::size_t length = 0;
+    if (context == nullptr ||
+        osvrClientGetStringParameterLength(context, "/display", &length) !=
+            OSVR_RETURN_SUCCESS ||
+        length == 0) {
+        return 0;
+    }
+    std::string display(length, '\0');
+    if (osvrClientGetStringParameter(context, "/display", &display[0],
+                                     length) != OSVR_RETURN_SUCCESS) {
+        return 0;
+    }
+    return renderinfocache::hashString(display);
+}
+
+inline bool SameViewsAsCache(RenderInfoSnapshot const &cached,
+                             RenderInfoSnapshot const &current) {
+    if (cached.count != current.count) {
+        return false;
+    }
+    for (std::size_t i = 0; i < current.count; ++i) {
+        auto &a = cached.info[i];
+        auto &b = current.info[i];
+        if (std::memcmp(&a.viewport, &b.viewport, sizeof(a.viewport)) != 0 ||
+            std::memcmp(&a.projection, &b.projection, sizeof(a.projection)) !=
+                0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Called once real render info has replaced @p previous: reports whether
+/// the provisional data held up and saves the real data for next time.
+inline void ReconcileWarmStartCache(RenderInfoSnapshot const &previous) {
+    RenderInfoSnapshot current;
+    s_lastRenderInfo.load(current);
+    if (current.provisional || current.count == 0) {
+        return;
+    }
+    if (previous.provisional) {
+        if (s_warmStartDisplayKey == s_displayConfigKey &&
+            SameViewsAsCache(previous, current)) {
+            // The cache is still right: nothing to save.
+            return;
+        }
+        DebugLog("[OSVR Rendering Plugin] Warm-start cache was stale, "
+                 "replacing it.");
+    }
+    renderinfocache::CachedView views[renderinfocache::kMaxViews];
+    const auto n = std::min(current.count, renderinfocache::kMaxViews);
+    for (std::size_t i = 0; i < n; ++i) {
+        views[i].viewport = current.info[i].viewport;
+        views[i].projection = current.info[i].projection;
+    }
+    if (!renderinfocache::save(renderinfocache::defaultPath(),
+                               s_displayConfigKey, views, n)) {
+        DebugLog("[OSVR Rendering Plugin] Could not write the warm-start "
+                 "cache.");
+    }
+}
+
 // --------------------------------------------------------------------------
 // UnitySetInterfaces
 void UNITY_INTERFACE_API UnityPluginLoad(IUnityInterfaces *unityInterfaces) {
@@ -307,9 +511,12 @@ void UNITY_INTERFACE_API UnityPluginLoad(IUnityInterfaces *unityInterfaces) {
 
     // Run OnGraphicsDeviceEvent(initialize) manually on plugin load
     OnGraphicsDeviceEvent(kUnityGfxDeviceEventInitialize);
+
+    LoadWarmStartCache();
 }
 
 void UNITY_INTERFACE_API UnityPluginUnload() {
+    CancelCreateRenderManagerAsync();
     s_Graphics->UnregisterDeviceEventCallback(OnGraphicsDeviceEvent);
     OnGraphicsDeviceEvent(kUnityGfxDeviceEventShutdown);
 
@@ -323,46 +530,153 @@ void UNITY_INTERFACE_API UnityPluginUnload() {
 #endif // defined(ENABLE_LOGGING) && defined(ENABLE_LOGFILE)
 }
 
-inline void UpdateRenderInfo() {
-	std::lock_guard<std::mutex> lock(m_mutex);
-    s_renderInfo = s_render->GetRenderInfo(s_renderParams);
-	if (s_renderInfo.size() > 0)
-	{
-		s_lastRenderInfo = s_renderInfo;
-	}
+inline std::chrono::microseconds ToMicroseconds(OSVR_TimeValue const &tv) {
+    return std::chrono::microseconds(tv.seconds * 1000000 + tv.microseconds);
 }
 
-#if 0
-extern "C" bool UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
-UpdateDistortionMesh(float distanceScale[2], float centerOfProjection[2],
-                     float *polynomial, int desiredTriangles = 12800) {
-    std::vector<osvr::renderkit::RenderManager::DistortionParameters> dp;
-    osvr::renderkit::RenderManager::DistortionParameters distortion;
-    distortion.m_desiredTriangles = desiredTriangles;
-    std::vector<float> Ds;
-    Ds.push_back(distanceScale[0]);
-    Ds.push_back(distanceScale[1]);
-    distortion.m_distortionD = Ds;
-    std::vector<float> poly;
-    int len = sizeof(polynomial) / sizeof(int);
-    for (size_t i = 0; i < len; i++) {
-        poly.push_back(polynomial[i]);
-    }
-    // assume each color is the same for now
-    distortion.m_distortionPolynomialRed = poly;
-    distortion.m_distortionPolynomialGreen = poly;
-    distortion.m_distortionPolynomialBlue = poly;
-    for (size_t i = 0; i < s_renderInfo.size(); i++) {
-        std::vector<float> COP = {static_cast<float>(centerOfProjection[0]),
-                                  static_cast<float>(centerOfProjection[1])};
-        distortion.m_distortionCOP = COP;
-        dp.push_back(distortion);
-    }
-    return s_render->UpdateDistortionMeshes(
-        osvr::renderkit::RenderManager::DistortionMeshType::SQUARE, dp);
+/// Eye poses as of each UpdateRenderInfo, for GetEyePoseAtTime. Written
+/// under s_renderInfoWriteMutex; read without locking.
+static posehistory::PoseHistory<kMaxViews> s_poseHistory;
+/// How far past the newest pose GetEyePoseAtTime will extrapolate.
+static const std::chrono::microseconds kMaxPoseExtrapolation(50000);
+
+/// Pose prediction, see SetPosePrediction.
+static std::atomic<bool> s_posePrediction{false};
+/// Negative to use s_measuredDisplayLatencyUs.
+static std::atomic<std::int64_t> s_requestedPredictionLeadUs{-1};
+/// Smoothed time from fetching render info to PresentRenderBuffers
+/// returning, for frames Unity rendered; written under s_renderMutex.
+static std::atomic<std::int64_t> s_measuredDisplayLatencyUs{0};
+/// Lead of the last prediction (0 if off), for GetPluginFrameStats.
+static std::atomic<std::int64_t> s_predictionLeadUs{0};
+/// Velocities are averaged over this much pose history.
+static const std::chrono::microseconds kPredictionVelocityWindow(20000);
+static const std::chrono::microseconds kMaxPredictionLead(100000);
+
+/// How far ahead of now the poses being fetched will be displayed.
+inline std::chrono::microseconds PredictionLead() {
+    const auto requested = s_requestedPredictionLeadUs.load();
+    std::chrono::microseconds lead(requested);
+    if (requested < 0) {
+        // Until the frame is handed over, plus half a refresh for scan-out.
+        lead = std::chrono::microseconds(s_measuredDisplayLatencyUs.load());
+        osvr::renderkit::RenderTimingInfo timing;
+        std::lock_guard<std::mutex> renderLock(s_renderMutex);
+        if (s_render->GetTimingInfo(0, timing)) {
+            lead += ToMicroseconds(timing.hardwareDisplayInterval) / 2;
+        }
+    }
+    return std::min(std::max(lead, std::chrono::microseconds(0)),
+                    kMaxPredictionLead);
 }
 
-#endif
+/// Moves the poses in @p renderInfo (just fetched at @p nowUs) ahead to when
+/// they will be displayed, at the velocity they moved with over the last
+/// kPredictionVelocityWindow of s_poseHistory. Both the frames Unity renders
+/// and the ones presented again (timewarp, the reprojection fallback) go
+/// through here, so a pose is predicted the same way whichever shows it.
+inline void PredictPoses(std::vector<osvr::renderkit::RenderInfo> &renderInfo,
+                         std::int64_t nowUs) {
+    if (!s_posePrediction) {
+        s_predictionLeadUs = 0;
+        return;
+    }
+    OSVR_TRACE_ZONE("PredictPoses");
+    const auto lead = PredictionLead();
+    s_predictionLeadUs = lead.count();
+    const auto n = std::min(renderInfo.size(), kMaxViews);
+    for (std::size_t i = 0; i < n; ++i) {
+        renderInfo[i].pose = posehistory::predict(
+            s_poseHistory, i, nowUs, renderInfo[i].pose,
+            kPredictionVelocityWindow.count(), lead.count());
+    }
+}
+
+/// The inputs and result of the last combined culling frustum computed, so
+/// it is only redone when a pose or projection (i.e. the IPD or clip
+/// distances) changed. Guarded by s_renderInfoWriteMutex.
+static std::size_t s_cullingFrustumViewCount = 0;
+static std::array<OSVR_PoseState, kMaxViews> s_cullingFrustumPoses;
+static std::array<osvr::renderkit::OSVR_ProjectionMatrix, kMaxViews>
+    s_cullingFrustumProjections;
+static bool s_hasCullingFrustum = false;
+static cullingfrustum::Frustum s_cullingFrustum;
+
+inline void UpdateCullingFrustum(RenderInfoSnapshot &snapshot) {
+    bool changed = snapshot.count != s_cullingFrustumViewCount;
+    for (std::size_t i = 0; i < snapshot.count && !changed; ++i) {
+        changed = std::memcmp(&snapshot.info[i].pose, &s_cullingFrustumPoses[i],
+                              sizeof(OSVR_PoseState)) != 0 ||
+                  std::memcmp(&snapshot.info[i].projection,
+                              &s_cullingFrustumProjections[i],
+                              sizeof(osvr::renderkit::OSVR_ProjectionMatrix)) !=
+                      0;
+    }
+    if (changed) {
+        OSVR_TRACE_ZONE("UpdateCullingFrustum");
+        s_cullingFrustumViewCount = snapshot.count;
+        for (std::size_t i = 0; i < snapshot.count; ++i) {
+            s_cullingFrustumPoses[i] = snapshot.info[i].pose;
+            s_cullingFrustumProjections[i] = snapshot.info[i].projection;
+        }
+        s_hasCullingFrustum = cullingfrustum::compute(
+            s_cullingFrustumPoses.data(), s_cullingFrustumProjections.data(),
+            snapshot.count, s_cullingFrustum);
+    }
+    snapshot.hasCullingFrustum = s_hasCullingFrustum;
+    snapshot.cullingFrustum = s_cullingFrustum;
+}
+
+inline void UpdateRenderInfo() {
+    if (s_render == nullptr) {
+        ++s_statUpdatesSkipped;
+        return;
+    }
+    OSVR_TRACE_ZONE("UpdateRenderInfo");
+    std::unique_lock<std::mutex> lock(s_renderInfoWriteMutex, std::defer_lock);
+    {
+        OSVR_TRACE_ZONE("RenderInfoWriteMutexWait");
+        lock.lock();
+    }
+    OSVR_TimeValue now;
+    osvrTimeValueGetNow(&now);
+    // s_renderInfo and the snapshot both have fixed storage that gets reused
+    // from frame to frame, so the plugin allocates nothing here in steady
+    // state. With MockRenderBackend the whole update is allocation-free;
+    // RenderManagerBackend::GetRenderInfo still allocates every frame.
+    {
+        OSVR_TRACE_ZONE("GetRenderInfo");
+        std::lock_guard<std::mutex> renderLock(s_renderMutex);
+        s_render->GetRenderInfo(s_renderParams, s_renderInfo);
+    }
+    if (s_renderInfo.empty()) {
+        ++s_statUpdatesSkipped;
+        return;
+    }
+    // The history keeps the poses as measured, not as predicted.
+    const auto nowUs = ToMicroseconds(now).count();
+    {
+        std::array<OSVR_PoseState, kMaxViews> poses;
+        const auto n = std::min(s_renderInfo.size(), kMaxViews);
+        for (std::size_t i = 0; i < n; ++i) {
+            poses[i] = s_renderInfo[i].pose;
+        }
+        s_poseHistory.push(nowUs, poses.data(), n);
+    }
+    PredictPoses(s_renderInfo, nowUs);
+    RenderInfoSnapshot snapshot;
+    snapshot.generation = ++s_renderInfoGeneration;
+    snapshot.timestamp = now;
+    snapshot.provisional = false;
+    snapshot.count = std::min(s_renderInfo.size(), kMaxViews);
+    std::copy_n(s_renderInfo.begin(), snapshot.count, snapshot.info.begin());
+    UpdateCullingFrustum(snapshot);
+    s_lastRenderInfo.store(snapshot);
+}
+
+inline bool isValidEye(RenderInfoSnapshot const &snapshot, int eye) {
+    return eye >= 0 && static_cast<std::size_t>(eye) < snapshot.count;
+}
 
 // Updates the internal "room to world" transformation (applied to all
 // tracker data for this client context instance) based on the user's head
@@ -372,35 +686,89 @@ UpdateDistortionMesh(float distanceScale[2], float centerOfProjection[2],
 // Note that this method internally calls osvrClientUpdate() to get a head pose
 // so your callbacks may be called during its execution!
 /// @todo does this actually get called from anywhere or is it dead code?
-void SetRoomRotationUsingHead() { s_render->SetRoomRotationUsingHead(); }
+void SetRoomRotationUsingHead() {
+    std::lock_guard<std::mutex> lock(s_renderMutex);
+    s_render->SetRoomRotationUsingHead();
+}
 
 // Clears/resets the internal "room to world" transformation back to an
 // identity transformation - that is, clears the effect of any other
 // manipulation of the room to world transform.
 /// @todo does this actually get called from anywhere or is it dead code?
-void ClearRoomToWorldTransform() { s_render->ClearRoomToWorldTransform(); }
+void ClearRoomToWorldTransform() {
+    std::lock_guard<std::mutex> lock(s_renderMutex);
+    s_render->ClearRoomToWorldTransform();
+}
+
+void UNITY_INTERFACE_API SetRenderBackend(int backend) {
+    switch (backend) {
+    case OSVR_UNITY_RENDER_BACKEND_RENDERMANAGER:
+    case OSVR_UNITY_RENDER_BACKEND_MOCK:
+        s_backendType = static_cast<OSVR_UnityRenderBackend>(backend);
+        break;
+    default:
+        DebugLog("[OSVR Rendering Plugin] SetRenderBackend: unknown backend, "
+                 "ignoring.");
+        break;
+    }
+}
+
+void UNITY_INTERFACE_API SetMockRenderBackendRefreshRate(double refreshRateHz) {
+    s_mockRefreshRateHz = refreshRateHz;
+}
 
-// Called from Unity to create a RenderManager, passing in a ClientContext
 OSVR_ReturnCode UNITY_INTERFACE_API
-CreateRenderManagerFromUnity(OSVR_ClientContext context) {
-    /// See if we're already created/running - shouldn't happen, but might.
-    if (s_render != nullptr) {
-        if (s_render->doingOkay()) {
-            DebugLog("[OSVR Rendering Plugin] RenderManager already created "
-                     "and doing OK - will just return success without trying "
-                     "to re-initialize.");
-            return OSVR_RETURN_SUCCESS;
-        }
+GetMockRenderBackendStats(OSVR_UnityMockRenderBackendStats *stats) {
+    // The present and timewarp threads may be presenting meanwhile.
+    std::lock_guard<std::mutex> lock(s_renderMutex);
+    auto mock = dynamic_cast<MockRenderBackend *>(s_render);
+    if (mock == nullptr || stats == nullptr) {
+        return OSVR_RETURN_FAILURE;
+    }
+    stats->presentCount = mock->presentCount();
+    stats->registeredBufferCount =
+        static_cast<int32_t>(mock->registeredBufferCount());
+    stats->registerCount = mock->registerCount();
+    auto &names = stats->registeredTextureNames;
+    for (std::size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i) {
+        names[i] = mock->registeredTextureName(i);
+    }
+    stats->lastPresentedBufferCount =
+        static_cast<int32_t>(mock->lastPresentedBufferCount());
+    stats->lastCroppingViewportCount =
+        static_cast<int32_t>(mock->lastCroppingViewportCount());
+    return OSVR_RETURN_SUCCESS;
+}
 
-        DebugLog("[OSVR Rendering Plugin] RenderManager already created, "
-                 "but not doing OK. Will shut down before creating again.");
-        ShutdownRenderManager();
+/// Creates the backend selected with SetRenderBackend. Returns nullptr on
+/// failure.
+inline RenderBackend *
+createRenderBackend(OSVR_ClientContext context, const char *renderLibraryName,
+                    osvr::renderkit::GraphicsLibrary const &library) {
+    if (s_backendType == OSVR_UNITY_RENDER_BACKEND_MOCK) {
+        DebugLog("[OSVR Rendering Plugin] Using the mock render backend.");
+        return new MockRenderBackend(library, s_mockRefreshRateHz);
+    }
+    if (renderLibraryName == nullptr) {
+        DebugLog("[OSVR Rendering Plugin] RenderManager needs a graphics "
+                 "device.");
+        return nullptr;
+    }
+    auto render = osvr::renderkit::createRenderManager(
+        context, renderLibraryName, library);
+    if (render == nullptr) {
+        return nullptr;
     }
+    return new RenderManagerBackend(render);
+}
+
+inline void SetClientContextAndDeviceType(OSVR_ClientContext context) {
     if (s_clientContext != nullptr) {
         DebugLog(
             "[OSVR Rendering Plugin] Client context already set! Replacing...");
     }
     s_clientContext = context;
+    s_displayConfigKey = GetDisplayConfigKey(context);
 
     if (!s_deviceType) {
 		// @todo pass the platform from Unity
@@ -416,7 +784,21 @@ CreateRenderManagerFromUnity(OSVR_ClientContext context) {
                  "plugin load/init routine. Order issue?");
         return OSVR_RETURN_FAILURE;*/
     }
+}
 
+/// Creates the backend for the current device type and opens its display,
+/// without touching s_render. @p library goes in as the library to create
+/// with and comes out as the one to render with. Returns nullptr on failure,
+/// with @p failureReason set to a string literal.
+///
+/// Only touches Unity's graphics device through RenderManager, so (except
+/// with OpenGL, whose context is bound to the render thread) it can run on a
+/// background thread.
+inline RenderBackend *
+OpenRenderBackend(OSVR_ClientContext context,
+                  osvr::renderkit::GraphicsLibrary &library,
+                  const char *&failureReason) {
+    RenderBackend *render = nullptr;
     bool setLibraryFromOpenDisplayReturn = false;
     /// @todo We should always have a legit value in
     /// s_deviceType.getDeviceTypeEnum() at this point, right?
@@ -424,8 +806,7 @@ CreateRenderManagerFromUnity(OSVR_ClientContext context) {
 
 #if SUPPORT_D3D11
     case OSVRSupportedRenderers::D3D11:
-        s_render = osvr::renderkit::createRenderManager(context, "Direct3D11",
-                                                        s_library);
+        render = createRenderBackend(context, "Direct3D11", library);
 #ifdef ATTEMPT_D3D_SHARING
         setLibraryFromOpenDisplayReturn = true;
 #endif // ATTEMPT_D3D_SHARING
@@ -434,40 +815,165 @@ CreateRenderManagerFromUnity(OSVR_ClientContext context) {
 
 #if SUPPORT_OPENGL
     case OSVRSupportedRenderers::OpenGL:
-        s_render = osvr::renderkit::createRenderManager(context, "OpenGL");
+        render = createRenderBackend(context, "OpenGL",
+                                     osvr::renderkit::GraphicsLibrary());
         setLibraryFromOpenDisplayReturn = true;
         break;
 #endif // SUPPORT_OPENGL
+
+    case OSVRSupportedRenderers::Null:
+        render = createRenderBackend(context, nullptr, library);
+        break;
+
+    case OSVRSupportedRenderers::EmptyRenderer:
+        break;
     }
 
-    if ((s_render == nullptr) || (!s_render->doingOkay())) {
+    if ((render == nullptr) || (!render->doingOkay())) {
         DebugLog("[OSVR Rendering Plugin] Could not create RenderManager");
-
-        ShutdownRenderManager();
-        return OSVR_RETURN_FAILURE;
+        delete render;
+        failureReason = "could not create RenderManager";
+        return nullptr;
     }
 
     // Open the display and make sure this worked.
-    osvr::renderkit::RenderManager::OpenResults ret = s_render->OpenDisplay();
+    osvr::renderkit::RenderManager::OpenResults ret = render->OpenDisplay();
     if (ret.status == osvr::renderkit::RenderManager::OpenStatus::FAILURE) {
         DebugLog("[OSVR Rendering Plugin] Could not open display");
-
-        ShutdownRenderManager();
-        return OSVR_RETURN_FAILURE;
+        delete render;
+        failureReason = "could not open display";
+        return nullptr;
     }
     if (setLibraryFromOpenDisplayReturn) {
         // Set our library from the one RenderManager created.
-        s_library = ret.library;
+        library = ret.library;
+    }
+    return render;
+}
+
+/// Makes an opened backend the current one.
+inline void StartUsingRenderBackend(
+    RenderBackend *render, osvr::renderkit::GraphicsLibrary const &library) {
+    {
+        std::lock_guard<std::mutex> lock(s_renderMutex);
+        s_render = render;
+        s_renderAvailable = true;
     }
+    s_library = library;
 
     // create a new set of RenderParams for passing to GetRenderInfo()
     s_renderParams = osvr::renderkit::RenderManager::RenderParams();
+    // Size the per-frame storage up front.
+    s_renderInfo.reserve(kMaxViews);
+    s_presentRenderInfo.reserve(kMaxViews);
+    RenderInfoSnapshot previous;
+    s_lastRenderInfo.load(previous);
     UpdateRenderInfo();
+    ReconcileWarmStartCache(previous);
+}
+
+/// Asks s_render whether it's doing okay; may be called from the main thread
+/// while the plugin's threads present.
+inline bool IsRenderBackendDoingOkay() {
+    std::lock_guard<std::mutex> lock(s_renderMutex);
+    return s_render->doingOkay();
+}
+
+inline bool IsCreateRenderManagerAsyncPending();
+inline void SetRenderManagerStatus(OSVR_UnityRenderManagerStatus status,
+                                   const char *failureReason = "");
+
+// Called from Unity to create a RenderManager, passing in a ClientContext
+OSVR_ReturnCode UNITY_INTERFACE_API
+CreateRenderManagerFromUnity(OSVR_ClientContext context) {
+    /// See if we're already created/running - shouldn't happen, but might.
+    if (s_render != nullptr) {
+        if (IsRenderBackendDoingOkay()) {
+            DebugLog("[OSVR Rendering Plugin] RenderManager already created "
+                     "and doing OK - will just return success without trying "
+                     "to re-initialize.");
+            return OSVR_RETURN_SUCCESS;
+        }
+
+        DebugLog("[OSVR Rendering Plugin] RenderManager already created, "
+                 "but not doing OK. Will shut down before creating again.");
+        ShutdownRenderManager();
+    }
+    if (IsCreateRenderManagerAsyncPending()) {
+        DebugLog("[OSVR Rendering Plugin] RenderManager is already being "
+                 "created asynchronously.");
+        return OSVR_RETURN_FAILURE;
+    }
+    SetClientContextAndDeviceType(context);
+
+    osvr::renderkit::GraphicsLibrary library = s_library;
+    const char *failureReason = nullptr;
+    RenderBackend *render = OpenRenderBackend(context, library, failureReason);
+    if (render == nullptr) {
+        ShutdownRenderManager();
+        SetRenderManagerStatus(OSVR_UNITY_RENDER_MANAGER_FAILED, failureReason);
+        return OSVR_RETURN_FAILURE;
+    }
+    StartUsingRenderBackend(render, library);
+    SetRenderManagerStatus(OSVR_UNITY_RENDER_MANAGER_READY);
 
     DebugLog("[OSVR Rendering Plugin] CreateRenderManagerFromUnity Success!");
     return OSVR_RETURN_SUCCESS;
 }
 
+inline bool IsSameRenderBuffer(osvr::renderkit::RenderBuffer const &a,
+                               osvr::renderkit::RenderBuffer const &b) {
+    return a.OpenGL == b.OpenGL && a.D3D11 == b.D3D11;
+}
+
+/// What each view's render buffer was constructed from, so reconfiguring
+/// can tell which ones are out of date.
+struct BuiltViewBuffer {
+    void *texture;
+    double width;
+    double height;
+};
+static std::array<BuiltViewBuffer, kMaxViews> s_builtViewBuffers = {};
+
+inline void *GetEyeTexturePtr(int view);
+
+inline BuiltViewBuffer DescribeViewBuffer(int view) {
+    BuiltViewBuffer ret;
+    ret.texture = GetEyeTexturePtr(view);
+    ret.width = s_renderInfo[view].viewport.width;
+    ret.height = s_renderInfo[view].viewport.height;
+    return ret;
+}
+
+inline bool operator==(BuiltViewBuffer const &a, BuiltViewBuffer const &b) {
+    return a.texture == b.texture && a.width == b.width &&
+           a.height == b.height;
+}
+
+/// Cleans up and clears s_renderBuffers.
+template <typename G> inline void cleanupRenderBuffers(G &&bufferCleanup) {
+    DebugLog("[OSVR Rendering Plugin] Cleaning up render buffers.");
+    for (auto it = s_renderBuffers.begin(); it != s_renderBuffers.end();
+         ++it) {
+        // Side-by-side eyes share one buffer: clean it up only once.
+        if (std::find_if(s_renderBuffers.begin(), it,
+                         [&](osvr::renderkit::RenderBuffer const &rb) {
+                             return IsSameRenderBuffer(rb, *it);
+                         }) == it) {
+            bufferCleanup(*it);
+        }
+    }
+    s_renderBuffers.clear();
+    DebugLog("[OSVR Rendering Plugin] Render buffer cleanup complete.");
+}
+
+/// Registers @p buffers with s_render, so that they can be presented.
+inline bool RegisterRenderBuffers(
+    std::vector<osvr::renderkit::RenderBuffer> const &buffers) {
+    std::lock_guard<std::mutex> lock(s_renderMutex);
+    return s_render->RegisterRenderBuffers(buffers);
+}
+
 /// Helper function that handles doing the loop of constructing buffers, and
 /// returning failure if any of them in the loop return failure.
 template <typename F, typename G>
@@ -476,27 +982,30 @@ inline OSVR_ReturnCode applyRenderBufferConstructor(const int numBuffers,
                                                     G &&bufferCleanup) {
     /// If we bail any time before the end, we'll automatically clean up the
     /// render buffers with this lambda.
-    auto cleanupBuffers = osvr::util::finally([&] {
-        DebugLog("[OSVR Rendering Plugin] Cleaning up render buffers.");
-        for (auto &rb : s_renderBuffers) {
-            bufferCleanup(rb);
-        }
-        s_renderBuffers.clear();
-        DebugLog("[OSVR Rendering Plugin] Render buffer cleanup complete.");
-    });
+    auto cleanupBuffers =
+        osvr::util::finally([&] { cleanupRenderBuffers(bufferCleanup); });
 
     /// Construct all the buffers as isntructed
     for (int i = 0; i < numBuffers; ++i) {
-        auto ret = bufferConstructor(i);
+        s_builtViewBuffers[i] = DescribeViewBuffer(i);
+        if (s_textureLayout == OSVR_UNITY_STEREO_TEXTURE_SIDE_BY_SIDE &&
+            i > 0) {
+            // Every eye presents (a different part of) the first buffer.
+            s_renderBuffers.push_back(s_renderBuffers.front());
+            continue;
+        }
+        osvr::renderkit::RenderBuffer rb;
+        auto ret = bufferConstructor(i, rb);
         if (ret != OSVR_RETURN_SUCCESS) {
             DebugLog("[OSVR Rendering Plugin] Failed in a buffer constructor!");
             return OSVR_RETURN_FAILURE;
         }
+        s_renderBuffers.push_back(rb);
     }
 
     /// Register our constructed buffers so that we can use them for
     /// presentation.
-    if (!s_render->RegisterRenderBuffers(s_renderBuffers)) {
+    if (!RegisterRenderBuffers(s_renderBuffers)) {
         DebugLog("RegisterRenderBuffers() returned false, cannot continue");
         return OSVR_RETURN_FAILURE;
     }
@@ -505,73 +1014,102 @@ inline OSVR_ReturnCode applyRenderBufferConstructor(const int numBuffers,
     return OSVR_RETURN_SUCCESS;
 }
 
-#if SUPPORT_OPENGL
-inline OSVR_ReturnCode ConstructBuffersOpenGL(int eye) {
-    // Init glew
-    glewExperimental = 1u;
-    /// @todo doesn't rendermanager do this glewInit for us?
-    GLenum err = glewInit();
-    if (err != GLEW_OK) {
-        DebugLog("glewInit failed, aborting.");
-        /// @todo shouldn't we return here then?
-    }
+inline bool isValidView(int view) {
+    return view >= 0 && static_cast<std::size_t>(view) < kMaxViews;
+}
 
-    if (eye == 0) {
-        // do this once
-        glGenFramebuffers(1, &s_frameBuffer);
-        glBindFramebuffer(GL_FRAMEBUFFER, s_frameBuffer);
+/// Unity's native texture for @p view, or nullptr if out of range.
+/// Side-by-side or as a texture array, all views share the texture set for
+/// view 0.
+inline void *GetEyeTexturePtr(int view) {
+    if (!isValidView(view)) {
+        return nullptr;
     }
+    return s_viewTextures[s_textureLayout == OSVR_UNITY_STEREO_TEXTURE_PER_EYE
+                              ? view
+                              : 0];
+}
 
-    // The color buffer for this eye.  We need to put this into
-    // a generic structure for the Present function, but we only need
-    // to fill in the OpenGL portion.
-    if (eye == 0) // left eye
-    {
-        GLuint leftEyeColorBuffer = 0;
-        glGenRenderbuffers(1, &leftEyeColorBuffer);
-        osvr::renderkit::RenderBuffer rb;
-        rb.OpenGL = new osvr::renderkit::RenderBufferOpenGL;
-        rb.OpenGL->colorBufferName = leftEyeColorBuffer;
-        s_renderBuffers.push_back(rb);
-        // "Bind" the newly created texture : all future texture
-        // functions will modify this texture glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, leftEyeColorBuffer);
-
-        // Give an empty image to OpenGL ( the last "0" means "empty" )
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB,
-                     static_cast<GLsizei>(s_renderInfo[eye].viewport.width),
-                     static_cast<GLsizei>(s_renderInfo[eye].viewport.height), 0,
-                     GL_RGB, GL_UNSIGNED_BYTE, &leftEyeColorBuffer);
-    } else // right eye
-    {
-        GLuint rightEyeColorBuffer = 0;
-        glGenRenderbuffers(1, &rightEyeColorBuffer);
-        osvr::renderkit::RenderBuffer rb;
-        rb.OpenGL = new osvr::renderkit::RenderBufferOpenGL;
-        rb.OpenGL->colorBufferName = rightEyeColorBuffer;
-        s_renderBuffers.push_back(rb);
-        // "Bind" the newly created texture : all future texture
-        // functions will modify this texture glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, rightEyeColorBuffer);
+#if SUPPORT_OPENGL
+/// On OpenGL, Unity's GetNativeTexturePtr() is the texture name.
+inline GLuint GetEyeTextureOpenGL(int eye) {
+    return static_cast<GLuint>(
+        reinterpret_cast<std::uintptr_t>(GetEyeTexturePtr(eye)));
+}
 
-        // Give an empty image to OpenGL ( the last "0" means "empty" )
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB,
-                     static_cast<GLsizei>(s_renderInfo[eye].viewport.width),
-                     static_cast<GLsizei>(s_renderInfo[eye].viewport.height), 0,
-                     GL_RGB, GL_UNSIGNED_BYTE, &rightEyeColorBuffer);
+/// RenderManager wants a plain 2D texture per eye: make one that aliases
+/// slice @p slice of Unity's (immutable) texture array, without copying.
+/// Returns 0 on failure.
+inline GLuint CreateSliceViewOpenGL(GLuint textureArray, int slice) {
+    if (!GLEW_ARB_texture_view) {
+        DebugLog("[OSVR Rendering Plugin] Texture array eye buffers need "
+                 "ARB_texture_view (OpenGL 4.3).");
+        return 0;
     }
+    GLint internalFormat = 0;
+    glBindTexture(GL_TEXTURE_2D_ARRAY, textureArray);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D_ARRAY, 0,
+                             GL_TEXTURE_INTERNAL_FORMAT, &internalFormat);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    // Clear stale errors so the check below only sees glTextureView's.
+    while (glGetError() != GL_NO_ERROR) {
+    }
+    GLuint view = 0;
+    glGenTextures(1, &view);
+    glTextureView(view, GL_TEXTURE_2D, textureArray,
+                  static_cast<GLenum>(internalFormat), 0, 1,
+                  static_cast<GLuint>(slice), 1);
+    if (glGetError() != GL_NO_ERROR) {
+        DebugLog("[OSVR Rendering Plugin] Could not create a view of the "
+                 "texture array slice for eye.");
+        glDeleteTextures(1, &view);
+        return 0;
+    }
+    return view;
+}
 
-    // Bilinear filtering
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
+inline OSVR_ReturnCode
+ConstructBuffersOpenGL(int eye, osvr::renderkit::RenderBuffer &rb) {
+    // Hand Unity's own texture to RenderManager: Unity renders straight into
+    // it and RenderManager reads straight from it, with no per-eye copy.
+    GLuint colorBuffer = GetEyeTextureOpenGL(eye);
+    if (colorBuffer == 0) {
+        DebugLog("[OSVR Rendering Plugin] No texture set for eye, call "
+                 "SetColorBufferFromUnity first.");
+        return OSVR_RETURN_FAILURE;
+    }
+    if (s_textureLayout == OSVR_UNITY_STEREO_TEXTURE_ARRAY) {
+        // The slice views are the only GL calls of our own, so only they
+        // need GLEW's entry points. Unity's context is current here.
+        if (eye == 0) {
+            glewExperimental = 1u;
+            GLenum err = glewInit();
+            if (err != GLEW_OK) {
+                DebugLog("[OSVR Rendering Plugin] glewInit failed, "
+                         "aborting.");
+                return OSVR_RETURN_FAILURE;
+            }
+        }
+        colorBuffer = CreateSliceViewOpenGL(colorBuffer, eye);
+        if (colorBuffer == 0) {
+            return OSVR_RETURN_FAILURE;
+        }
+    }
+    rb.OpenGL = new osvr::renderkit::RenderBufferOpenGL;
+    rb.OpenGL->colorBufferName = colorBuffer;
+    // RenderManager only samples the color buffer when presenting.
+    rb.OpenGL->depthStencilBufferName = 0;
     return OSVR_RETURN_SUCCESS;
 }
 
 inline void CleanupBufferOpenGL(osvr::renderkit::RenderBuffer &rb) {
-    /// @todo incomplete cleanup - but better than leaking in case of failure.
+    // The texture belongs to Unity; only our wrapper (and slice view, if
+    // any) are ours to delete.
+    if (s_textureLayout == OSVR_UNITY_STEREO_TEXTURE_ARRAY &&
+        rb.OpenGL != nullptr) {
+        glDeleteTextures(1, &rb.OpenGL->colorBufferName);
+    }
     delete rb.OpenGL;
     rb.OpenGL = nullptr;
 }
@@ -579,11 +1117,11 @@ inline void CleanupBufferOpenGL(osvr::renderkit::RenderBuffer &rb) {
 
 #if SUPPORT_D3D11
 inline ID3D11Texture2D *GetEyeTextureD3D11(int eye) {
-    return reinterpret_cast<ID3D11Texture2D *>(eye == 0 ? s_leftEyeTexturePtr
-                                                        : s_rightEyeTexturePtr);
+    return reinterpret_cast<ID3D11Texture2D *>(GetEyeTexturePtr(eye));
 }
 
-inline OSVR_ReturnCode ConstructBuffersD3D11(int eye) {
+inline OSVR_ReturnCode
+ConstructBuffersD3D11(int eye, osvr::renderkit::RenderBuffer &rb) {
     DebugLog("[OSVR Rendering Plugin] ConstructBuffersD3D11");
     HRESULT hr;
     // The color buffer for this eye.  We need to put this into
@@ -595,7 +1133,31 @@ inline OSVR_ReturnCode ConstructBuffersD3D11(int eye) {
     unsigned width = static_cast<unsigned>(s_renderInfo[eye].viewport.width);
     unsigned height = static_cast<unsigned>(s_renderInfo[eye].viewport.height);
 
+    if (D3DTexture == nullptr) {
+        DebugLog("[OSVR Rendering Plugin] No texture set for eye, call "
+                 "SetColorBufferFromUnity first.");
+        return OSVR_RETURN_FAILURE;
+    }
     D3DTexture->GetDesc(&s_textureDesc);
+    if (s_textureLayout == OSVR_UNITY_STEREO_TEXTURE_ARRAY) {
+        // RenderManager samples its buffers as plain 2D textures, so each
+        // eye gets its own, copied from its array slice every frame in
+        // RenderViewD3D11.
+        D3D11_TEXTURE2D_DESC eyeDesc = s_textureDesc;
+        eyeDesc.MipLevels = 1;
+        eyeDesc.ArraySize = 1;
+        eyeDesc.BindFlags =
+            D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+        eyeDesc.MiscFlags = 0;
+        D3DTexture = nullptr;
+        hr = s_renderInfo[eye].library.D3D11->device->CreateTexture2D(
+            &eyeDesc, nullptr, &D3DTexture);
+        if (FAILED(hr)) {
+            DebugLog("[OSVR Rendering Plugin] Could not create texture for "
+                     "array slice");
+            return OSVR_RETURN_FAILURE;
+        }
+    }
 
     // Fill in the resource view for your render texture buffer here
     D3D11_RENDER_TARGET_VIEW_DESC renderTargetViewDesc = {};
@@ -617,17 +1179,18 @@ inline OSVR_ReturnCode ConstructBuffersD3D11(int eye) {
     if (FAILED(hr)) {
         DebugLog(
             "[OSVR Rendering Plugin] Could not create render target for eye");
+        if (s_textureLayout == OSVR_UNITY_STEREO_TEXTURE_ARRAY) {
+            D3DTexture->Release();
+        }
         return OSVR_RETURN_FAILURE;
     }
 
-    // Push the filled-in RenderBuffer onto the stack.
+    // Hand back the filled-in RenderBuffer.
     std::unique_ptr<osvr::renderkit::RenderBufferD3D11> rbD3D(
         new osvr::renderkit::RenderBufferD3D11);
     rbD3D->colorBuffer = D3DTexture;
     rbD3D->colorBufferView = renderTargetView;
-    osvr::renderkit::RenderBuffer rb;
     rb.D3D11 = rbD3D.get();
-    s_renderBuffers.push_back(rb);
 
     // OK, we succeeded, must release ownership of that pointer now that it's in
     // RenderManager's hands.
@@ -636,20 +1199,61 @@ inline OSVR_ReturnCode ConstructBuffersD3D11(int eye) {
 }
 
 inline void CleanupBufferD3D11(osvr::renderkit::RenderBuffer &rb) {
+    if (rb.D3D11 != nullptr && rb.D3D11->colorBufferView != nullptr) {
+        rb.D3D11->colorBufferView->Release();
+    }
+    // Per-slice textures are ours; Unity's eye textures aren't.
+    if (s_textureLayout == OSVR_UNITY_STEREO_TEXTURE_ARRAY &&
+        rb.D3D11 != nullptr) {
+        rb.D3D11->colorBuffer->Release();
+    }
     delete rb.D3D11;
     rb.D3D11 = nullptr;
 }
 #endif // SUPPORT_D3D11
 
+/// With no graphics device there's nothing to allocate: register placeholder
+/// buffers so the backend still sees one per eye.
+inline OSVR_ReturnCode ConstructBuffersNull(int,
+                                            osvr::renderkit::RenderBuffer &) {
+    return OSVR_RETURN_SUCCESS;
+}
+
+inline void CleanupBufferNull(osvr::renderkit::RenderBuffer &) {}
+
 OSVR_ReturnCode UNITY_INTERFACE_API ConstructRenderBuffers() {
     if (!s_deviceType) {
         DebugLog("Device type not supported.");
         return OSVR_RETURN_FAILURE;
     }
+    if (s_render == nullptr) {
+        DebugLog("[OSVR Rendering Plugin] ConstructRenderBuffers: no "
+                 "RenderManager (yet).");
+        return OSVR_RETURN_FAILURE;
+    }
+    // Nothing may present while s_renderBuffers changes.
+    StopPresentThread();
     UpdateRenderInfo();
 
-    // construct buffers
-    const int n = static_cast<int>(s_renderInfo.size());
+    // construct buffers, one per view RenderManager reports
+    if (s_renderInfo.size() > kMaxViews) {
+        DebugLog("[OSVR Rendering Plugin] More views than the plugin "
+                 "supports, only using the first ones.");
+    }
+    const int n = static_cast<int>(std::min(s_renderInfo.size(), kMaxViews));
+    s_textureLayout = s_requestedTextureLayout;
+    s_croppingViewports.clear();
+    if (s_textureLayout == OSVR_UNITY_STEREO_TEXTURE_SIDE_BY_SIDE) {
+        // Eye i presents the i-th of n equal columns of the shared texture.
+        for (int i = 0; i < n; ++i) {
+            osvr::renderkit::OSVR_ViewportDescription vp;
+            vp.left = static_cast<double>(i) / n;
+            vp.lower = 0.;
+            vp.width = 1. / n;
+            vp.height = 1.;
+            s_croppingViewports.push_back(vp);
+        }
+    }
     switch (s_deviceType.getDeviceTypeEnum()) {
 #if SUPPORT_D3D11
     case OSVRSupportedRenderers::D3D11:
@@ -663,6 +1267,9 @@ OSVR_ReturnCode UNITY_INTERFACE_API ConstructRenderBuffers() {
                                             CleanupBufferOpenGL);
         break;
 #endif
+    case OSVRSupportedRenderers::Null:
+        return applyRenderBufferConstructor(n, ConstructBuffersNull,
+                                            CleanupBufferNull);
     case OSVRSupportedRenderers::EmptyRenderer:
     default:
         DebugLog("Device type not supported.");
@@ -670,36 +1277,504 @@ OSVR_ReturnCode UNITY_INTERFACE_API ConstructRenderBuffers() {
     }
 }
 
-void UNITY_INTERFACE_API SetNearClipDistance(double distance) {
-    s_nearClipDistance = distance;
-    s_renderParams.nearClipDistanceMeters = s_nearClipDistance;
-}
+/// Rebuilds just the views whose texture or size changed since they were
+/// constructed, then registers the new set in one go. If anything fails, the
+/// old buffers stay registered and in use.
+template <typename F, typename G>
+inline OSVR_ReturnCode applyRenderBufferReconfigure(const int numBuffers,
+                                                    F &&bufferConstructor,
+                                                    G &&bufferCleanup) {
+    std::array<BuiltViewBuffer, kMaxViews> wanted;
+    std::array<bool, kMaxViews> changed = {};
+    int numChanged = 0;
+    for (int i = 0; i < numBuffers; ++i) {
+        wanted[i] = DescribeViewBuffer(i);
+        changed[i] = !(wanted[i] == s_builtViewBuffers[i]);
+        numChanged += changed[i] ? 1 : 0;
+    }
+    if (numChanged == 0) {
+        return OSVR_RETURN_SUCCESS;
+    }
 
-void UNITY_INTERFACE_API SetFarClipDistance(double distance) {
-    s_farClipDistance = distance;
-    s_renderParams.farClipDistanceMeters = s_farClipDistance;
-}
+    std::vector<osvr::renderkit::RenderBuffer> next(s_renderBuffers);
+    auto cleanupNewBuffers = osvr::util::finally([&] {
+        for (int i = 0; i < numBuffers; ++i) {
+            if (!IsSameRenderBuffer(next[i], s_renderBuffers[i])) {
+                bufferCleanup(next[i]);
+            }
+        }
+    });
+    for (int i = 0; i < numBuffers; ++i) {
+        if (!changed[i]) {
+            continue;
+        }
+        osvr::renderkit::RenderBuffer rb;
+        if (bufferConstructor(i, rb) != OSVR_RETURN_SUCCESS) {
+            DebugLog("[OSVR Rendering Plugin] Failed in a buffer constructor "
+                     "while reconfiguring, keeping the old buffers.");
+            return OSVR_RETURN_FAILURE;
+        }
+        next[i] = rb;
+    }
 
-void UNITY_INTERFACE_API SetIPD(double ipdMeters) {
-    s_ipd = ipdMeters;
-    s_renderParams.IPDMeters = s_ipd;
+    // The present thread may be presenting the old buffers right now; it
+    // restarts with the next render event.
+    StopPresentThread();
+    if (!RegisterRenderBuffers(next)) {
+        DebugLog("[OSVR Rendering Plugin] RegisterRenderBuffers() returned "
+                 "false while reconfiguring, keeping the old buffers.");
+        return OSVR_RETURN_FAILURE;
+    }
+    cleanupNewBuffers.cancel();
+    for (int i = 0; i < numBuffers; ++i) {
+        if (changed[i]) {
+            bufferCleanup(s_renderBuffers[i]);
+            s_builtViewBuffers[i] = wanted[i];
+        }
+    }
+    s_renderBuffers.swap(next);
+    DebugLog("[OSVR Rendering Plugin] Reconfigured render buffers.");
+    return OSVR_RETURN_SUCCESS;
 }
 
-osvr::renderkit::OSVR_ViewportDescription UNITY_INTERFACE_API
-GetViewport(int eye) {
-	std::lock_guard<std::mutex> lock(m_mutex);
-	return s_lastRenderInfo[eye].viewport;
-}
+/// Called on the render thread for kOsvrEventID_Reconfigure: picks up new
+/// eye textures and render info sizes while RenderManager and its display
+/// stay up. Changes to the number of views or the texture layout (and
+/// side-by-side, which has only one buffer) rebuild all buffers.
+inline OSVR_ReturnCode ReconfigureRenderBuffers() {
+    if (s_render == nullptr) {
+        return OSVR_RETURN_FAILURE;
+    }
+    UpdateRenderInfo();
+    const int n = static_cast<int>(std::min(s_renderInfo.size(), kMaxViews));
+    const bool rebuildAll =
+        s_requestedTextureLayout != s_textureLayout ||
+        s_textureLayout == OSVR_UNITY_STEREO_TEXTURE_SIDE_BY_SIDE ||
+        static_cast<std::size_t>(n) != s_renderBuffers.size();
 
-osvr::renderkit::OSVR_ProjectionMatrix UNITY_INTERFACE_API
-GetProjectionMatrix(int eye) {
-	std::lock_guard<std::mutex> lock(m_mutex);
-	return s_lastRenderInfo[eye].projection;
+    switch (s_deviceType.getDeviceTypeEnum()) {
+#if SUPPORT_D3D11
+    case OSVRSupportedRenderers::D3D11:
+        if (!rebuildAll) {
+            return applyRenderBufferReconfigure(n, ConstructBuffersD3D11,
+                                                CleanupBufferD3D11);
+        }
+        StopPresentThread();
+        cleanupRenderBuffers(CleanupBufferD3D11);
+        break;
+#endif
+#if SUPPORT_OPENGL
+    case OSVRSupportedRenderers::OpenGL:
+        if (!rebuildAll) {
+            return applyRenderBufferReconfigure(n, ConstructBuffersOpenGL,
+                                                CleanupBufferOpenGL);
+        }
+        StopPresentThread();
+        cleanupRenderBuffers(CleanupBufferOpenGL);
+        break;
+#endif
+    case OSVRSupportedRenderers::Null:
+        if (!rebuildAll) {
+            return applyRenderBufferReconfigure(n, ConstructBuffersNull,
+                                                CleanupBufferNull);
+        }
+        StopPresentThread();
+        cleanupRenderBuffers(CleanupBufferNull);
+        break;
+    case OSVRSupportedRenderers::EmptyRenderer:
+    default:
+        return OSVR_RETURN_FAILURE;
+    }
+    return ConstructRenderBuffers();
 }
 
-OSVR_Pose3 UNITY_INTERFACE_API GetEyePose(int eye) {
-	std::lock_guard<std::mutex> lock(m_mutex);
-	return s_lastRenderInfo[eye].pose;
+/// Set between BeforeReset and AfterReset if there were buffers to restore.
+static bool s_restoreBuffersAfterReset = false;
+
+/// Called on the render thread for kUnityGfxDeviceEventBeforeReset: stops
+/// presenting and releases everything tied to the graphics device (render
+/// target views, our own textures), but leaves RenderManager and its
+/// display alone.
+inline void ReleaseRenderBuffersForReset() {
+    if (s_render == nullptr || s_renderBuffers.empty()) {
+        return;
+    }
+    StopPresentThread();
+    switch (s_deviceType.getDeviceTypeEnumUnconditionally()) {
+#if SUPPORT_D3D11
+    case OSVRSupportedRenderers::D3D11:
+        cleanupRenderBuffers(CleanupBufferD3D11);
+        break;
+#endif
+#if SUPPORT_OPENGL
+    case OSVRSupportedRenderers::OpenGL:
+        cleanupRenderBuffers(CleanupBufferOpenGL);
+        break;
+#endif
+    default:
+        cleanupRenderBuffers(CleanupBufferNull);
+        break;
+    }
+    s_restoreBuffersAfterReset = true;
+}
+
+/// Called on the render thread for kUnityGfxDeviceEventAfterReset: rebuilds
+/// and re-registers the buffers released by ReleaseRenderBuffersForReset.
+inline void RestoreRenderBuffersAfterReset() {
+    if (!s_restoreBuffersAfterReset) {
+        return;
+    }
+    s_restoreBuffersAfterReset = false;
+    if (s_render == nullptr) {
+        return;
+    }
+    if (ConstructRenderBuffers() != OSVR_RETURN_SUCCESS) {
+        DebugLog("[OSVR Rendering Plugin] Could not restore render buffers "
+                 "after the device reset.");
+    }
+}
+
+// --------------------------------------------------------------------------
+// Asynchronous creation
+//
+// CreateRenderManagerFromUnityAsync opens the backend on a background thread
+// (with OpenGL, at the next render event, since the context lives there).
+// The render thread then takes it over at its next event and reports the
+// outcome, so s_render is only ever set on the render thread. The render
+// buffers are left to ConstructRenderBuffers, as with the synchronous
+// version: Unity usually hasn't set its eye textures yet at this point.
+
+static std::atomic<int> s_renderManagerStatus{OSVR_UNITY_RENDER_MANAGER_NONE};
+/// Always a string literal.
+static std::atomic<const char *> s_renderManagerFailureReason{""};
+static OSVR_UnityRenderManagerStatusFnPtr s_asyncCallback = nullptr;
+
+/// Guards the rest of the async state.
+static std::mutex s_asyncMutex;
+static std::thread s_asyncThread;
+static bool s_asyncOpenOnRenderThread = false;
+/// Set when opening has finished, successfully or not.
+static bool s_asyncOpened = false;
+static OSVR_ClientContext s_asyncContext = nullptr;
+/// Opened, but not yet taken over by the render thread.
+static RenderBackend *s_asyncRender = nullptr;
+static osvr::renderkit::GraphicsLibrary s_asyncLibrary;
+
+inline bool IsCreateRenderManagerAsyncPending() {
+    return s_renderManagerStatus == OSVR_UNITY_RENDER_MANAGER_PENDING;
+}
+
+inline void SetRenderManagerStatus(OSVR_UnityRenderManagerStatus status,
+                                   const char *failureReason) {
+    s_renderManagerFailureReason = failureReason;
+    s_renderManagerStatus = status;
+}
+
+inline void OpenRenderBackendAsync() {
+    osvr::renderkit::GraphicsLibrary library;
+    OSVR_ClientContext context;
+    {
+        std::lock_guard<std::mutex> lock(s_asyncMutex);
+        library = s_asyncLibrary;
+        context = s_asyncContext;
+    }
+    const char *failureReason = "";
+    RenderBackend *render = OpenRenderBackend(context, library, failureReason);
+
+    std::lock_guard<std::mutex> lock(s_asyncMutex);
+    s_asyncRender = render;
+    s_asyncLibrary = library;
+    s_renderManagerFailureReason = failureReason;
+    s_asyncOpened = true;
+}
+
+/// Waits for a background open to finish and throws away its result.
+inline void CancelCreateRenderManagerAsync() {
+    std::thread thread;
+    {
+        std::lock_guard<std::mutex> lock(s_asyncMutex);
+        thread = std::move(s_asyncThread);
+    }
+    if (thread.joinable()) {
+        thread.join();
+    }
+    std::lock_guard<std::mutex> lock(s_asyncMutex);
+    delete s_asyncRender;
+    s_asyncRender = nullptr;
+    s_asyncOpened = false;
+    s_asyncOpenOnRenderThread = false;
+    SetRenderManagerStatus(OSVR_UNITY_RENDER_MANAGER_NONE);
+}
+
+/// Called on the render thread before each event: takes over a backend
+/// opened asynchronously.
+inline void FinishCreateRenderManagerAsync() {
+    if (!IsCreateRenderManagerAsyncPending()) {
+        return;
+    }
+    RenderBackend *render = nullptr;
+    osvr::renderkit::GraphicsLibrary library;
+    const char *failureReason = "";
+    {
+        std::unique_lock<std::mutex> lock(s_asyncMutex);
+        if (s_asyncOpenOnRenderThread) {
+            s_asyncOpenOnRenderThread = false;
+            lock.unlock();
+            OpenRenderBackendAsync();
+            lock.lock();
+        }
+        if (!s_asyncOpened) {
+            return;
+        }
+        // The thread is done with the shared state, so this won't wait long.
+        if (s_asyncThread.joinable()) {
+            s_asyncThread.join();
+        }
+        s_asyncOpened = false;
+        render = s_asyncRender;
+        s_asyncRender = nullptr;
+        library = s_asyncLibrary;
+        failureReason = s_renderManagerFailureReason;
+    }
+
+    auto status = OSVR_UNITY_RENDER_MANAGER_FAILED;
+    if (render != nullptr) {
+        StartUsingRenderBackend(render, library);
+        status = OSVR_UNITY_RENDER_MANAGER_READY;
+    }
+    if (status == OSVR_UNITY_RENDER_MANAGER_READY) {
+        DebugLog("[OSVR Rendering Plugin] Asynchronous RenderManager "
+                 "creation succeeded.");
+        SetRenderManagerStatus(status);
+    } else {
+        DebugLog("[OSVR Rendering Plugin] Asynchronous RenderManager "
+                 "creation failed.");
+        ShutdownRenderManager();
+        SetRenderManagerStatus(status, failureReason);
+    }
+    if (s_asyncCallback != nullptr) {
+        s_asyncCallback(status);
+    }
+}
+
+OSVR_ReturnCode UNITY_INTERFACE_API
+CreateRenderManagerFromUnityAsync(OSVR_ClientContext context,
+                                  OSVR_UnityRenderManagerStatusFnPtr callback) {
+    if (IsCreateRenderManagerAsyncPending()) {
+        DebugLog("[OSVR Rendering Plugin] RenderManager is already being "
+                 "created asynchronously.");
+        return OSVR_RETURN_SUCCESS;
+    }
+    if (s_render != nullptr) {
+        if (IsRenderBackendDoingOkay()) {
+            DebugLog("[OSVR Rendering Plugin] RenderManager already created "
+                     "and doing OK.");
+            SetRenderManagerStatus(OSVR_UNITY_RENDER_MANAGER_READY);
+            if (callback != nullptr) {
+                callback(OSVR_UNITY_RENDER_MANAGER_READY);
+            }
+            return OSVR_RETURN_SUCCESS;
+        }
+        DebugLog("[OSVR Rendering Plugin] RenderManager already created, "
+                 "but not doing OK. Will shut down before creating again.");
+        ShutdownRenderManager();
+    }
+    // Reap the thread of an earlier asynchronous creation.
+    CancelCreateRenderManagerAsync();
+    SetClientContextAndDeviceType(context);
+
+    std::lock_guard<std::mutex> lock(s_asyncMutex);
+    s_asyncCallback = callback;
+    s_asyncContext = context;
+    s_asyncLibrary = s_library;
+    SetRenderManagerStatus(OSVR_UNITY_RENDER_MANAGER_PENDING);
+    if (s_deviceType.getDeviceTypeEnum() == OSVRSupportedRenderers::OpenGL) {
+        s_asyncOpenOnRenderThread = true;
+    } else {
+        s_asyncThread = std::thread(OpenRenderBackendAsync);
+    }
+    return OSVR_RETURN_SUCCESS;
+}
+
+int UNITY_INTERFACE_API GetRenderManagerStatus(char *failureReason,
+                                               int failureReasonSize) {
+    const int status = s_renderManagerStatus;
+    if (failureReason != nullptr && failureReasonSize > 0) {
+        const char *reason = status == OSVR_UNITY_RENDER_MANAGER_FAILED
+                                 ? s_renderManagerFailureReason.load()
+                                 : "";
+        std::strncpy(failureReason, reason,
+                     static_cast<std::size_t>(failureReasonSize));
+        failureReason[failureReasonSize - 1] = '\0';
+    }
+    return status;
+}
+
+void UNITY_INTERFACE_API SetStereoTextureLayout(int layout) {
+    switch (layout) {
+    case OSVR_UNITY_STEREO_TEXTURE_PER_EYE:
+    case OSVR_UNITY_STEREO_TEXTURE_SIDE_BY_SIDE:
+    case OSVR_UNITY_STEREO_TEXTURE_ARRAY:
+        s_requestedTextureLayout =
+            static_cast<OSVR_UnityStereoTextureLayout>(layout);
+        break;
+    default:
+        DebugLog("[OSVR Rendering Plugin] SetStereoTextureLayout: unknown "
+                 "layout, ignoring.");
+        break;
+    }
+}
+
+void UNITY_INTERFACE_API SetNearClipDistance(double distance) {
+    s_nearClipDistance = distance;
+    s_renderParams.nearClipDistanceMeters = s_nearClipDistance;
+}
+
+void UNITY_INTERFACE_API SetFarClipDistance(double distance) {
+    s_farClipDistance = distance;
+    s_renderParams.farClipDistanceMeters = s_farClipDistance;
+}
+
+void UNITY_INTERFACE_API SetIPD(double ipdMeters) {
+    s_ipd = ipdMeters;
+    s_renderParams.IPDMeters = s_ipd;
+}
+
+void UNITY_INTERFACE_API SetPosePrediction(int enabled, double leadSeconds) {
+    s_requestedPredictionLeadUs =
+        leadSeconds < 0. ? -1 : static_cast<std::int64_t>(leadSeconds * 1e6);
+    s_posePrediction = enabled != 0;
+}
+
+// These getters are called from the Unity main thread: they read from the
+// published snapshot and never block on the render thread. Out-of-range eyes
+// (or no render info yet) get a zeroed result.
+osvr::renderkit::OSVR_ViewportDescription UNITY_INTERFACE_API
+GetViewport(int eye) {
+    return s_lastRenderInfo.read([eye](RenderInfoSnapshot const &s) {
+        return isValidEye(s, eye) ? s.info[eye].viewport
+                                  : osvr::renderkit::OSVR_ViewportDescription{};
+    });
+}
+
+osvr::renderkit::OSVR_ProjectionMatrix UNITY_INTERFACE_API
+GetProjectionMatrix(int eye) {
+    return s_lastRenderInfo.read([eye](RenderInfoSnapshot const &s) {
+        return isValidEye(s, eye) ? s.info[eye].projection
+                                  : osvr::renderkit::OSVR_ProjectionMatrix{};
+    });
+}
+
+int UNITY_INTERFACE_API
+GetAllEyeRenderData(OSVR_UnityEyeRenderData *eyes, int maxEyes,
+                    OSVR_UnityRenderDataHeader *header) {
+    const std::size_t maxOut = (eyes == nullptr || maxEyes < 0)
+                                   ? 0
+                                   : static_cast<std::size_t>(maxEyes);
+    return s_lastRenderInfo.read([&](RenderInfoSnapshot const &s) {
+        const auto n = std::min(s.count, maxOut);
+        for (std::size_t i = 0; i < n; ++i) {
+            eyes[i].pose = s.info[i].pose;
+            eyes[i].projection = s.info[i].projection;
+            eyes[i].viewport = s.info[i].viewport;
+        }
+        if (header != nullptr) {
+            header->generation = s.generation;
+            header->timestamp = s.timestamp;
+            header->eyeCount = static_cast<int32_t>(s.count);
+            header->provisional = s.provisional ? 1 : 0;
+        }
+        return static_cast<int>(s.count);
+    });
+}
+
+int UNITY_INTERFACE_API GetEyeMatrices(OSVR_UnityEyeMatrices *eyes,
+                                       int maxEyes, int clipSpace,
+                                       OSVR_UnityRenderDataHeader *header) {
+    eyematrices::ClipSpace space;
+    switch (clipSpace) {
+    case OSVR_UNITY_CLIP_SPACE_OPENGL:
+        space = eyematrices::ClipSpace::OpenGL;
+        break;
+    case OSVR_UNITY_CLIP_SPACE_D3D:
+        space = eyematrices::ClipSpace::D3D;
+        break;
+    case OSVR_UNITY_CLIP_SPACE_D3D_REVERSED_Z:
+        space = eyematrices::ClipSpace::D3DReversedZ;
+        break;
+    default:
+        return -1;
+    }
+    const std::size_t maxOut = (eyes == nullptr || maxEyes < 0)
+                                   ? 0
+                                   : static_cast<std::size_t>(maxEyes);
+    // Copy the inputs out of the snapshot first: the conversion shouldn't
+    // be repeated if the read has to retry.
+    std::array<OSVR_PoseState, kMaxViews> poses;
+    std::array<osvr::renderkit::OSVR_ProjectionMatrix, kMaxViews> projections;
+    OSVR_UnityRenderDataHeader h;
+    s_lastRenderInfo.read([&](RenderInfoSnapshot const &s) {
+        for (std::size_t i = 0; i < s.count; ++i) {
+            poses[i] = s.info[i].pose;
+            projections[i] = s.info[i].projection;
+        }
+        h.generation = s.generation;
+        h.timestamp = s.timestamp;
+        h.eyeCount = static_cast<int32_t>(s.count);
+        h.provisional = s.provisional ? 1 : 0;
+        return 0;
+    });
+    const auto n = std::min(static_cast<std::size_t>(h.eyeCount), maxOut);
+    float view[kMaxViews][16];
+    eyematrices::viewMatrices(poses.data(), n, view);
+    for (std::size_t i = 0; i < n; ++i) {
+        std::copy_n(view[i], 16, eyes[i].view);
+        eyematrices::projectionMatrix(projections[i], space,
+                                      eyes[i].projection);
+    }
+    if (header != nullptr) {
+        *header = h;
+    }
+    return h.eyeCount;
+}
+
+OSVR_Pose3 UNITY_INTERFACE_API GetEyePose(int eye) {
+    return s_lastRenderInfo.read([eye](RenderInfoSnapshot const &s) {
+        return isValidEye(s, eye) ? s.info[eye].pose : OSVR_Pose3{};
+    });
+}
+
+OSVR_ReturnCode UNITY_INTERFACE_API
+GetCullingFrustum(OSVR_UnityCullingFrustum *frustum) {
+    if (frustum == nullptr) {
+        return OSVR_RETURN_FAILURE;
+    }
+    return s_lastRenderInfo.read(
+        [frustum](RenderInfoSnapshot const &s) -> OSVR_ReturnCode {
+            if (!s.hasCullingFrustum) {
+                return OSVR_RETURN_FAILURE;
+            }
+            auto const &f = s.cullingFrustum;
+            frustum->origin = f.origin;
+            frustum->projection = f.projection;
+            std::memcpy(frustum->planes, f.planes, sizeof(f.planes));
+            cullingfrustum::toUnityPlanes(f, frustum->unityPlanes);
+            frustum->generation = s.generation;
+            return OSVR_RETURN_SUCCESS;
+        });
+}
+
+OSVR_ReturnCode UNITY_INTERFACE_API GetEyePoseAtTime(int eye,
+                                                    OSVR_TimeValue time,
+                                                    OSVR_Pose3 *pose) {
+    if (eye < 0 || pose == nullptr) {
+        return OSVR_RETURN_FAILURE;
+    }
+    return s_poseHistory.sample(static_cast<std::size_t>(eye),
+                                ToMicroseconds(time).count(),
+                                kMaxPoseExtrapolation.count(), *pose)
+               ? OSVR_RETURN_SUCCESS
+               : OSVR_RETURN_FAILURE;
 }
 
 // --------------------------------------------------------------------------
@@ -721,14 +1796,21 @@ int UNITY_INTERFACE_API SetColorBufferFromUnity(void *texturePtr, int eye) {
     }
 
     DebugLog("[OSVR Rendering Plugin] SetColorBufferFromUnity");
-    if (eye == 0) {
-        s_leftEyeTexturePtr = texturePtr;
-    } else {
-        s_rightEyeTexturePtr = texturePtr;
+    if (!isValidView(eye)) {
+        DebugLog("[OSVR Rendering Plugin] SetColorBufferFromUnity: eye index "
+                 "out of range.");
+        return OSVR_RETURN_FAILURE;
     }
+    s_viewTextures[eye] = texturePtr;
 
     return OSVR_RETURN_SUCCESS;
 }
+
+int UNITY_INTERFACE_API GetViewCount() {
+    return s_lastRenderInfo.read([](RenderInfoSnapshot const &s) {
+        return static_cast<int>(s.count);
+    });
+}
 #if SUPPORT_D3D11
 // Renders the view from our Unity cameras by copying data at
 // Unity.RenderTexture.GetNativeTexturePtr() to RenderManager colorBuffers
@@ -739,109 +1821,823 @@ void RenderViewD3D11(const osvr::renderkit::RenderInfo &ri,
 	context->OMSetRenderTargets(1, &renderTargetView, NULL);
 
 	// copy the updated RenderTexture from Unity to RenderManager colorBuffer
+	if (s_textureLayout == OSVR_UNITY_STEREO_TEXTURE_ARRAY) {
+		// GPU-side copy of this eye's slice (mip 0) into its own texture:
+		// RenderManager creates its shader resource views for plain 2D
+		// textures, so unlike OpenGL's texture views the slice can't be
+		// registered as is. Costs a full eye image of bandwidth each way.
+		context->CopySubresourceRegion(
+			s_renderBuffers[eyeIndex].D3D11->colorBuffer, 0, 0, 0, 0,
+			GetEyeTextureD3D11(eyeIndex),
+			D3D11CalcSubresource(0, static_cast<UINT>(eyeIndex),
+			                     s_textureDesc.MipLevels),
+			nullptr);
+		return;
+	}
 	s_renderBuffers[eyeIndex].D3D11->colorBuffer = GetEyeTextureD3D11(eyeIndex);
 }
 #endif // SUPPORT_D3D11
 
 #if SUPPORT_OPENGL
-// Render the world from the specified point of view.
-//@todo This is not functional yet.
-inline void RenderViewOpenGL(
-    const osvr::renderkit::RenderInfo &ri, //< Info needed to render
-    GLuint frameBufferObj, //< Frame buffer object to bind our buffers to
-    GLuint colorBuffer,    //< Color buffer to render into
-    int eyeIndex) {
-    // Render to our framebuffer
-    glBindFramebuffer(GL_FRAMEBUFFER, frameBufferObj);
-
-    // Set color and depth buffers for the frame buffer
-    glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, colorBuffer, 0);
-    // glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
-    // GL_RENDERBUFFER, depthBuffer);
-
-    // Set the list of draw buffers.
-    GLenum DrawBuffers[1] = {GL_COLOR_ATTACHMENT0};
-    glDrawBuffers(1, DrawBuffers); // "1" is the size of DrawBuffers
-
-    // Always check that our framebuffer is ok
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
-        DebugLog("RenderView: Incomplete Framebuffer");
+// Unity has already rendered into the registered texture, so all that's left
+// is to pick up a texture Unity may have recreated (e.g. on resize) since the
+// buffers were constructed.
+inline void RenderViewOpenGL(int eyeIndex) {
+    if (s_textureLayout == OSVR_UNITY_STEREO_TEXTURE_ARRAY) {
+        // Slice views stay tied to the array they were made from.
         return;
     }
-
-    // Set the viewport to cover our entire render texture.
-    glViewport(0, 0, static_cast<GLsizei>(ri.viewport.width),
-               static_cast<GLsizei>(ri.viewport.height));
-
-    // Set the OpenGL projection matrix
-    GLdouble projection[16];
-    osvr::renderkit::OSVR_Projection_to_OpenGL(projection, ri.projection);
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    glMultMatrixd(projection);
-
-    /// Put the transform into the OpenGL ModelView matrix
-    GLdouble modelView[16];
-    osvr::renderkit::OSVR_PoseState_to_OpenGL(modelView, ri.pose);
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
-    glMultMatrixd(modelView);
-
-    // Clear the screen to red and clear depth
-    glClearColor(1, 0, 0, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-    // =================================================================
-    // This is where we draw our world and hands and any other objects.
-    // We're in World Space.  To find out about where to render objects
-    // in OSVR spaces (like left/right hand space) we need to query the
-    // interface and handle the coordinate tranforms ourselves.
-
-    // update native texture from code
-    glBindTexture(GL_TEXTURE_2D,
-                  s_renderBuffers[eyeIndex].OpenGL->colorBufferName);
-    int texWidth, texHeight;
-    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &texWidth);
-    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &texHeight);
-
-    GLuint glTex = eyeIndex == 0 ? (GLuint)s_leftEyeTexturePtr
-                                 : (GLuint)s_rightEyeTexturePtr;
-
-    // unsigned char* data = new unsigned char[texWidth*texHeight * 4];
-    // FillTextureFromCode(texWidth, texHeight, texHeight * 4, data);
-    // glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, texWidth, texHeight, GL_RGBA,
-    // GL_UNSIGNED_BYTE, (GLuint));
-    // delete[] data;
-    // Draw a cube with a 5-meter radius as the room we are floating in.
-    // draw_cube(5.0);
+    s_renderBuffers[eyeIndex].OpenGL->colorBufferName =
+        GetEyeTextureOpenGL(eyeIndex);
 }
 #endif // SUPPORT_OPENGL
 
+inline std::int64_t SteadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+/// Folds a frame that was just presented into s_measuredDisplayLatencyUs
+/// (an exponential moving average). Call under s_renderMutex.
+inline void UpdateMeasuredDisplayLatency(OSVR_TimeValue const &fetchedAt) {
+    OSVR_TimeValue now;
+    osvrTimeValueGetNow(&now);
+    const auto latency = static_cast<std::int64_t>(
+        osvrTimeValueDurationSeconds(&now, &fetchedAt) * 1e6);
+    const auto prev =
+        s_measuredDisplayLatencyUs.load(std::memory_order_relaxed);
+    s_measuredDisplayLatencyUs.store(prev == 0 ? latency
+                                               : prev + (latency - prev) / 8,
+                                     std::memory_order_relaxed);
+}
+
+/// Hands a frame to the backend.
+/// @param buffers The registered buffers holding the frame's images.
+/// @param fetchedAt When the poses in @p renderInfo were fetched.
+/// @param reprojected Whether the buffers are being presented again.
+inline void
+PresentRenderInfo(std::vector<osvr::renderkit::RenderBuffer> const &buffers,
+                  std::vector<osvr::renderkit::RenderInfo> const &renderInfo,
+                  OSVR_TimeValue const &fetchedAt, bool reprojected = false) {
+    bool flipInY = false;
+#if SUPPORT_D3D11
+    // Flip Y because Unity RenderTextures are upside-down on D3D11
+    flipInY = s_deviceType.getDeviceTypeEnumUnconditionally() ==
+              OSVRSupportedRenderers::D3D11;
+#endif // SUPPORT_D3D11
+    OSVR_TimeValue now;
+    osvrTimeValueGetNow(&now);
+    s_poseAgeAtPresentHistogram.record(
+        osvrTimeValueDurationSeconds(&now, &fetchedAt) * 1e6);
+
+    std::unique_lock<std::mutex> renderLock(s_renderMutex, std::defer_lock);
+    {
+        OSVR_TRACE_ZONE("RenderMutexWait");
+        renderLock.lock();
+    }
+    OSVR_TRACE_ZONE("PresentRenderBuffers");
+    const auto start = SteadyNowNs();
+    const bool presented = s_render->PresentRenderBuffers(
+        buffers, renderInfo, s_presentParams, s_croppingViewports, flipInY);
+    s_presentDurationHistogram.record((SteadyNowNs() - start) / 1e3);
+    if (presented) {
+        ++s_statFramesPresented;
+        if (reprojected) {
+            ++s_statFramesReprojected;
+        } else {
+            UpdateMeasuredDisplayLatency(fetchedAt);
+        }
+    } else {
+        ++s_statPresentFailures;
+        DebugLog("[OSVR Rendering Plugin] PresentRenderBuffers() returned "
+                 "false, maybe because it was asked to quit");
+    }
+}
+
+// --------------------------------------------------------------------------
+// Distortion meshes
+
+/// Whether UpdateDistortionMesh uses the on-disk mesh cache.
+static std::atomic<bool> s_distortionMeshCacheEnabled{true};
+/// Guards the three below.
+static std::mutex s_distortionMutex;
+/// Meshes from the last successful UpdateDistortionMesh, one per eye.
+static std::vector<distortionmesh::Mesh> s_distortionMeshes;
+/// What those meshes leave unsampled, one per eye.
+static std::vector<distortionmesh::HiddenAreaMesh> s_hiddenAreaMeshes;
+/// Waiting for the render thread to hand them to the backend.
+static std::vector<osvr::renderkit::RenderManager::DistortionParameters>
+    s_pendingDistortion;
+
+/// Describes eye @p eye's generated mesh to RenderManager as
+/// rgb_point_samples: each sample maps a screen position to where one color
+/// samples the rendered image. RenderManager looks an eye's samples up by
+/// its index, so the entries for the other @p eyeCount eyes stay empty.
+inline osvr::renderkit::RenderManager::DistortionParameters
+ToPointSamples(distortionmesh::Mesh const &mesh, std::size_t eye,
+               std::size_t eyeCount) {
+    osvr::renderkit::RenderManager::DistortionParameters ret;
+    ret.m_type = osvr::renderkit::RenderManager::DistortionParameters::
+        rgb_point_samples;
+    for (int c = 0; c < distortionmesh::ColorCount; ++c) {
+        auto &perEye = ret.m_rgbPointSamples[c];
+        perEye.resize(eyeCount);
+        auto const &pos = mesh.positions;
+        auto const &tex = mesh.texCoords[c];
+        auto &samples = perEye[eye];
+        samples.resize(pos.size() / 2);
+        for (std::size_t i = 0; i < samples.size(); ++i) {
+            samples[i][0] = {{pos[2 * i], pos[2 * i + 1]}};
+            samples[i][1] = {{tex[2 * i], tex[2 * i + 1]}};
+        }
+    }
+    return ret;
+}
+
+OSVR_ReturnCode UNITY_INTERFACE_API
+UpdateDistortionMesh(const OSVR_UnityDistortionParameters *eyes, int eyeCount,
+                     int desiredTriangles) {
+    // Not s_render itself: the render thread hands the meshes over later,
+    // under s_renderMutex, and taking that here would wait out a present.
+    if (!s_renderAvailable) {
+        DebugLog("[OSVR Rendering Plugin] UpdateDistortionMesh: no "
+                 "RenderManager (yet).");
+        return OSVR_RETURN_FAILURE;
+    }
+    if (eyes == nullptr || eyeCount <= 0 || desiredTriangles <= 0) {
+        DebugLog("[OSVR Rendering Plugin] UpdateDistortionMesh: invalid "
+                 "arguments.");
+        return OSVR_RETURN_FAILURE;
+    }
+    std::vector<distortionmesh::EyeDistortion> distortion(eyeCount);
+    for (int e = 0; e < eyeCount; ++e) {
+        auto const &in = eyes[e];
+        auto &out = distortion[e];
+        if (in.distanceScale[0] == 0.f || in.distanceScale[1] == 0.f) {
+            DebugLog("[OSVR Rendering Plugin] UpdateDistortionMesh: distance "
+                     "scale must not be zero.");
+            return OSVR_RETURN_FAILURE;
+        }
+        out.centerOfProjection = {
+            {in.centerOfProjection[0], in.centerOfProjection[1]}};
+        out.distanceScale = {{in.distanceScale[0], in.distanceScale[1]}};
+        for (int c = 0; c < distortionmesh::ColorCount; ++c) {
+            const int length = in.polynomialLength[c];
+            if (length < 0 || (length > 0 && in.polynomial[c] == nullptr)) {
+                DebugLog("[OSVR Rendering Plugin] UpdateDistortionMesh: "
+                         "invalid polynomial.");
+                return OSVR_RETURN_FAILURE;
+            }
+            out.polynomials[c].assign(in.polynomial[c],
+                                      in.polynomial[c] + length);
+        }
+    }
+
+    const auto meshType =
+        osvr::renderkit::RenderManager::DistortionMeshType::SQUARE;
+    const auto triangles = static_cast<std::size_t>(desiredTriangles);
+    const auto cacheKey = distortionmeshcache::key(
+        distortion, triangles, static_cast<int>(meshType));
+    const bool useCache = s_distortionMeshCacheEnabled;
+    std::vector<distortionmesh::Mesh> meshes;
+    if (!useCache || !distortionmeshcache::load(
+                         distortionmeshcache::pathFor(cacheKey), cacheKey,
+                         meshes)) {
+        try {
+            OSVR_TRACE_ZONE("GenerateDistortionMeshes");
+            distortionmesh::generate(distortion, triangles, meshes);
+        } catch (std::exception const &) {
+            DebugLog("[OSVR Rendering Plugin] UpdateDistortionMesh: could "
+                     "not generate the meshes.");
+            return OSVR_RETURN_FAILURE;
+        }
+        if (useCache &&
+            !distortionmeshcache::save(distortionmeshcache::pathFor(cacheKey),
+                                       cacheKey, meshes)) {
+            DebugLog("[OSVR Rendering Plugin] Could not write the distortion "
+                     "mesh cache.");
+        }
+    }
+    std::vector<distortionmesh::HiddenAreaMesh> hiddenAreas(meshes.size());
+    for (std::size_t e = 0; e < meshes.size(); ++e) {
+        distortionmesh::buildHiddenArea(distortion[e], meshes[e],
+                                        hiddenAreas[e]);
+    }
+    std::vector<osvr::renderkit::RenderManager::DistortionParameters> params;
+    params.reserve(meshes.size());
+    for (std::size_t e = 0; e < meshes.size(); ++e) {
+        params.push_back(ToPointSamples(meshes[e], e, meshes.size()));
+    }
+    std::lock_guard<std::mutex> lock(s_distortionMutex);
+    s_distortionMeshes.swap(meshes);
+    s_hiddenAreaMeshes.swap(hiddenAreas);
+    s_pendingDistortion.swap(params);
+    return OSVR_RETURN_SUCCESS;
+}
+
+OSVR_ReturnCode UNITY_INTERFACE_API
+GetHiddenAreaMesh(int eye, float *vertices, int maxVertices, int32_t *indices,
+                  int maxIndices, int32_t *vertexCount, int32_t *indexCount) {
+    std::lock_guard<std::mutex> lock(s_distortionMutex);
+    if (eye < 0 || static_cast<std::size_t>(eye) >= s_hiddenAreaMeshes.size()) {
+        return OSVR_RETURN_FAILURE;
+    }
+    auto const &mesh = s_hiddenAreaMeshes[eye];
+    const auto numVertices = static_cast<int>(mesh.vertices.size() / 2);
+    const auto numIndices = static_cast<int>(mesh.indices.size());
+    if (vertexCount != nullptr) {
+        *vertexCount = numVertices;
+    }
+    if (indexCount != nullptr) {
+        *indexCount = numIndices;
+    }
+    if (vertices == nullptr && indices == nullptr) {
+        // Just asking for the sizes.
+        return OSVR_RETURN_SUCCESS;
+    }
+    if (vertices == nullptr || indices == nullptr ||
+        maxVertices < numVertices || maxIndices < numIndices) {
+        return OSVR_RETURN_FAILURE;
+    }
+    std::copy(mesh.vertices.begin(), mesh.vertices.end(), vertices);
+    std::copy(mesh.indices.begin(), mesh.indices.end(), indices);
+    return OSVR_RETURN_SUCCESS;
+}
+
+void UNITY_INTERFACE_API SetDistortionMeshCache(int enabled) {
+    s_distortionMeshCacheEnabled = enabled != 0;
+}
+
+/// Called on the render thread: hands meshes from UpdateDistortionMesh to
+/// the backend between presents, rather than waiting out a present (and its
+/// vsync) on the caller's thread.
+inline void ApplyPendingDistortion() {
+    std::vector<osvr::renderkit::RenderManager::DistortionParameters> params;
+    {
+        std::lock_guard<std::mutex> lock(s_distortionMutex);
+        if (s_pendingDistortion.empty()) {
+            return;
+        }
+        params.swap(s_pendingDistortion);
+    }
+    OSVR_TRACE_ZONE("UpdateDistortionMeshes");
+    std::lock_guard<std::mutex> lock(s_renderMutex);
+    if (s_render == nullptr) {
+        return;
+    }
+    // Point samples are interpolated the same way whatever the mesh type.
+    if (!s_render->UpdateDistortionMeshes(
+            osvr::renderkit::RenderManager::DistortionMeshType::SQUARE,
+            params)) {
+        DebugLog("[OSVR Rendering Plugin] UpdateDistortionMeshes() returned "
+                 "false.");
+    }
+}
+
+// --------------------------------------------------------------------------
+// Present thread
+//
+// Opt-in (SetPresentThreadMode): kOsvrEventID_Render only queues the frame and
+// a plugin-owned thread calls PresentRenderBuffers, so vsync waits and
+// distortion work in the backend don't stall Unity's render thread. The
+// thread is (re)started and stopped from the render thread as the requested
+// mode changes, and stopped before the backend is destroyed.
+//
+// Each queued frame carries a set of buffers of its own, from
+// s_presentBufferSets, so that the images presented are the ones rendered
+// with its poses however far behind the thread is, and Unity can go on
+// rendering meanwhile. The same sets keep the latest complete frame for the
+// timewarp thread. Both threads only run where the backend presents on a
+// graphics context of its own: with D3D11 and OpenGL, RenderManager presents
+// on Unity's context, which only Unity's render thread may use. That leaves
+// the null device, whose buffers hold no images, so a set is just a copy of
+// the registered buffers.
+
+/// Requested max frames in flight; 0 means present synchronously.
+static std::atomic<int> s_requestedMaxFramesInFlight{0};
+static std::atomic<FrameQueueFullPolicy> s_presentQueuePolicy{
+    FrameQueueFullPolicy::Block};
+
+/// Guards the buffer sets, queue and thread below (not the counters). Taken
+/// before s_timewarpThreadMutex when both are needed.
+static std::mutex s_presentThreadMutex;
+static int s_runningMaxFramesInFlight = 0;
+
+/// A frame queued for the present thread.
+struct QueuedFrame {
+    RenderInfoSnapshot renderInfo;
+    /// Which of s_presentBufferSets holds its images; the frame holds it
+    /// until presented or dropped.
+    std::size_t bufferSet;
+};
+typedef BufferSetRing<std::vector<osvr::renderkit::RenderBuffer>>
+    PresentBufferSets;
+
+/// Only while the present or timewarp thread runs.
+static std::unique_ptr<PresentBufferSets> s_presentBufferSets;
+static std::unique_ptr<FrameQueue<QueuedFrame>> s_presentQueue;
+static std::thread s_presentThread;
+/// Whether frames are going through the present thread.
+static std::atomic<bool> s_presentThreadRunning{false};
+
+static std::atomic<std::uint64_t> s_framesEnqueued{0};
+static std::atomic<std::uint64_t> s_framesDropped{0};
+static std::atomic<std::uint64_t> s_framesPresentedByThread{0};
+
+inline void PresentThreadLoop(FrameQueue<QueuedFrame> &queue,
+                              PresentBufferSets &bufferSets) {
+    QueuedFrame frame;
+    std::vector<osvr::renderkit::RenderInfo> renderInfo;
+    renderInfo.reserve(kMaxViews);
+    while (queue.pop(frame)) {
+        auto const &snapshot = frame.renderInfo;
+        renderInfo.assign(snapshot.info.begin(),
+                          snapshot.info.begin() + snapshot.count);
+        PresentRenderInfo(bufferSets[frame.bufferSet], renderInfo,
+                          snapshot.timestamp);
+        bufferSets.release(frame.bufferSet);
+        ++s_framesPresentedByThread;
+    }
+}
+
+/// Whether the plugin's own threads may present: only if that won't touch
+/// Unity's graphics context. Also what lets a buffer set be a plain copy of
+/// s_renderBuffers: with a device, each set would need GPU copies of Unity's
+/// eye textures, made on the render thread, which aren't implemented.
+inline bool CanPresentOffRenderThread() {
+    return s_deviceType.getDeviceTypeEnumUnconditionally() ==
+           OSVRSupportedRenderers::Null;
+}
+
+/// Makes the buffer sets, unless there already are some: one per queued
+/// frame, plus the ones being presented, written, kept as the latest and
+/// reprojected by the timewarp thread. Registers them all along with
+/// s_renderBuffers, which synchronous presents keep using. Caller must hold
+/// s_presentThreadMutex.
+inline bool CreatePresentBufferSetsLocked() {
+    if (s_presentBufferSets) {
+        return true;
+    }
+    std::unique_ptr<PresentBufferSets> sets(new PresentBufferSets(
+        static_cast<std::size_t>(s_runningMaxFramesInFlight) + 4));
+    std::vector<osvr::renderkit::RenderBuffer> all(s_renderBuffers);
+    for (std::size_t i = 0; i < sets->size(); ++i) {
+        // The null device's buffers are placeholders with no images, so
+        // copies of them are all a set needs (see CanPresentOffRenderThread).
+        (*sets)[i] = s_renderBuffers;
+        all.insert(all.end(), s_renderBuffers.begin(), s_renderBuffers.end());
+    }
+    if (!RegisterRenderBuffers(all)) {
+        DebugLog("[OSVR Rendering Plugin] Could not register the buffers "
+                 "to present from other threads.");
+        return false;
+    }
+    s_presentBufferSets = std::move(sets);
+    return true;
+}
+
+/// Caller must hold s_presentThreadMutex.
+inline void StopPresentThreadLocked() {
+    if (s_presentQueue) {
+        // The thread presents what's still queued before it exits.
+        s_presentQueue->close();
+        s_presentThread.join();
+        s_presentQueue.reset();
+        s_presentThreadRunning = false;
+        DebugLog("[OSVR Rendering Plugin] Present thread stopped.");
+    }
+    s_runningMaxFramesInFlight = 0;
+}
+
+/// Caller must hold s_presentThreadMutex.
+inline void StartPresentThreadLocked(int maxFramesInFlight) {
+    s_runningMaxFramesInFlight = maxFramesInFlight;
+    if (!CanPresentOffRenderThread()) {
+        DebugLog("[OSVR Rendering Plugin] Present thread only supported "
+                 "without a graphics device, presenting synchronously.");
+        return;
+    }
+    if (!CreatePresentBufferSetsLocked()) {
+        return;
+    }
+    s_presentQueue.reset(new FrameQueue<QueuedFrame>(
+        static_cast<std::size_t>(maxFramesInFlight)));
+    auto &queue = *s_presentQueue;
+    auto &bufferSets = *s_presentBufferSets;
+    s_presentThread = std::thread(
+        [&queue, &bufferSets] { PresentThreadLoop(queue, bufferSets); });
+    s_presentThreadRunning = true;
+    DebugLog("[OSVR Rendering Plugin] Present thread started.");
+}
+
+inline void StopTimewarpThread();
+
+/// Stops the present thread and the timewarp thread, then drops the buffer
+/// sets, so that nothing but the render thread presents. Caller must hold
+/// s_presentThreadMutex.
+inline void StopPresentThreadsLocked() {
+    StopPresentThreadLocked();
+    StopTimewarpThread();
+    s_presentBufferSets.reset();
+}
+
+/// Stops the present and timewarp threads; they restart at the next render
+/// event if still requested.
+inline void StopPresentThread() {
+    std::lock_guard<std::mutex> lock(s_presentThreadMutex);
+    StopPresentThreadsLocked();
+}
+
+/// Queues @p frame for the present thread, which takes over its hold on its
+/// buffer set. Returns false, with the hold still the caller's, if the queue
+/// has been closed. Caller must hold s_presentThreadMutex.
+inline bool EnqueueForPresentThreadLocked(QueuedFrame const &frame) {
+    OSVR_TRACE_ZONE("PresentQueuePush");
+    QueuedFrame dropped;
+    switch (s_presentQueue->push(frame, s_presentQueuePolicy, &dropped)) {
+    case FrameQueuePushResult::QueuedDroppingOldest:
+        s_presentBufferSets->release(dropped.bufferSet);
+        ++s_framesDropped;
+    // fall through
+    case FrameQueuePushResult::Queued:
+        ++s_framesEnqueued;
+        return true;
+    case FrameQueuePushResult::Closed:
+    default:
+        return false;
+    }
+}
+
+/// Called on the render thread with the frame Unity just rendered, loaded by
+/// LoadPresentRenderInfo: (re)starts the present thread to match the
+/// requested mode, then queues the frame for it or presents it right away.
+/// While there are buffer sets, the frame takes one of its own, which also
+/// becomes the latest complete frame for the timewarp thread.
+inline void SubmitFrame() {
+    const int requested = s_requestedMaxFramesInFlight;
+    std::unique_lock<std::mutex> lock(s_presentThreadMutex, std::defer_lock);
+    {
+        OSVR_TRACE_ZONE("PresentThreadMutexWait");
+        lock.lock();
+    }
+    if (requested != s_runningMaxFramesInFlight) {
+        // The buffer sets are sized for the old mode; the timewarp thread
+        // restarts with new ones in UpdateTimewarpThread.
+        StopPresentThreadsLocked();
+        if (requested > 0) {
+            StartPresentThreadLocked(requested);
+        }
+    }
+    QueuedFrame frame;
+    // There is a set for every frame that can be in flight, so acquiring one
+    // only fails if there are no sets.
+    frame.bufferSet = s_presentBufferSets ? s_presentBufferSets->acquire()
+                                          : PresentBufferSets::npos;
+    if (frame.bufferSet == PresentBufferSets::npos) {
+        lock.unlock();
+        PresentRenderInfo(s_renderBuffers, s_presentRenderInfo,
+                          s_presentSnapshot.timestamp);
+        return;
+    }
+    auto &bufferSets = *s_presentBufferSets;
+    // Null device buffers have no images, so there's nothing to copy in.
+    bufferSets.publish(frame.bufferSet);
+    if (s_presentQueue) {
+        frame.renderInfo = s_presentSnapshot;
+        if (EnqueueForPresentThreadLocked(frame)) {
+            return;
+        }
+    }
+    // Only the render thread drops the sets, so they outlive this present.
+    lock.unlock();
+    PresentRenderInfo(bufferSets[frame.bufferSet], s_presentRenderInfo,
+                      s_presentSnapshot.timestamp);
+    bufferSets.release(frame.bufferSet);
+}
+
+void UNITY_INTERFACE_API SetPresentThreadMode(int maxFramesInFlight,
+                                              int queuePolicy) {
+    s_presentQueuePolicy = queuePolicy == OSVR_UNITY_PRESENT_QUEUE_DROP_OLDEST
+                               ? FrameQueueFullPolicy::DropOldest
+                               : FrameQueueFullPolicy::Block;
+    s_requestedMaxFramesInFlight = std::max(maxFramesInFlight, 0);
+}
+
+OSVR_ReturnCode UNITY_INTERFACE_API
+GetPresentQueueStats(OSVR_UnityPresentQueueStats *stats) {
+    if (stats == nullptr) {
+        return OSVR_RETURN_FAILURE;
+    }
+    // Read "presented" first so the depth can't come out negative.
+    const std::uint64_t presented = s_framesPresentedByThread;
+    const std::uint64_t dropped = s_framesDropped;
+    const std::uint64_t enqueued = s_framesEnqueued;
+    stats->maxFramesInFlight = s_requestedMaxFramesInFlight;
+    stats->framesEnqueued = enqueued;
+    stats->framesPresented = presented;
+    stats->framesDropped = dropped;
+    stats->queueDepth = static_cast<int32_t>(
+        enqueued > dropped + presented ? enqueued - dropped - presented : 0);
+    return OSVR_RETURN_SUCCESS;
+}
+
+// --------------------------------------------------------------------------
+// Timewarp thread
+//
+// Opt-in (SetTimewarpThreadMode): a plugin-owned thread wakes a little before
+// each vsync and, if no Unity frame has been handed over since it last
+// looked, presents the latest complete frame (from s_presentBufferSets) again
+// with freshly fetched render info, so RenderManager's timewarp reprojects the
+// stale images to the current pose. Like the present thread, it's (re)started
+// from the render thread, stopped whenever the buffers or the backend are
+// about to change, and only runs without a graphics device: RenderManager
+// presents on the context it was opened with, Unity's, and can't open the
+// same display again on a context of our own, so on D3D11 and OpenGL there's
+// no asynchronous timewarp, only the reprojection fallback below.
+
+/// How long before vsync the timewarp thread checks for a missed frame.
+static const std::chrono::microseconds kTimewarpLeadTime(3000);
+/// Check interval when the backend can't tell when vsync is.
+static const std::chrono::microseconds kTimewarpFallbackInterval(11111);
+
+static std::atomic<bool> s_requestedTimewarp{false};
+static std::atomic<int> s_requestedTimewarpPriority{
+    OSVR_UNITY_THREAD_PRIORITY_HIGH};
+static std::atomic<std::uint64_t> s_requestedTimewarpAffinity{0};
+/// Bumped by SetTimewarpThreadMode; 0 means never called.
+static std::atomic<std::uint64_t> s_timewarpModeGeneration{0};
+/// Unity frames handed to presentation, so the thread can spot a miss.
+static std::atomic<std::uint64_t> s_unityFramesSubmitted{0};
+/// Render thread only: when the last of them was handed over.
+static std::int64_t s_lastSubmitNs = 0;
+
+/// Guards the thread and s_runningTimewarpModeGeneration.
+static std::mutex s_timewarpThreadMutex;
+static std::uint64_t s_runningTimewarpModeGeneration = 0;
+static std::thread s_timewarpThread;
+static std::atomic<bool> s_timewarpRunning{false};
+
+/// Guards s_timewarpStopRequested, which the thread sleeps on.
+static std::mutex s_timewarpStopMutex;
+static std::condition_variable s_timewarpStopCondition;
+static bool s_timewarpStopRequested = false;
+
+/// How long the timewarp thread should sleep before its next check.
+inline std::chrono::microseconds TimeUntilTimewarpCheck() {
+    osvr::renderkit::RenderTimingInfo timing;
+    {
+        std::lock_guard<std::mutex> lock(s_renderMutex);
+        if (!s_render->GetTimingInfo(0, timing)) {
+            return kTimewarpFallbackInterval;
+        }
+    }
+    const auto interval = ToMicroseconds(timing.hardwareDisplayInterval);
+    auto wait = interval - ToMicroseconds(timing.timeSincelastVerticalRetrace) -
+                kTimewarpLeadTime;
+    if (wait.count() <= 0) {
+        // Too late for this vsync: aim for the next one.
+        wait += interval;
+    }
+    return wait;
+}
+
+/// Presents the latest complete frame again with a fresh pose, predicted
+/// like any other when pose prediction is on. Holds its buffer set meanwhile,
+/// so the render thread writes newer frames elsewhere.
+inline void
+ReprojectLastFrame(PresentBufferSets &bufferSets,
+                   std::vector<osvr::renderkit::RenderInfo> &renderInfo) {
+    const auto bufferSet = bufferSets.acquireLatest();
+    if (bufferSet == PresentBufferSets::npos) {
+        // Nothing submitted since the sets were made.
+        return;
+    }
+    OSVR_TRACE_ZONE("TimewarpReproject");
+    OSVR_TimeValue now;
+    {
+        std::lock_guard<std::mutex> lock(s_renderMutex);
+        osvrTimeValueGetNow(&now);
+        s_render->GetRenderInfo(s_renderParams, renderInfo);
+    }
+    if (!renderInfo.empty()) {
+        PredictPoses(renderInfo, ToMicroseconds(now).count());
+        PresentRenderInfo(bufferSets[bufferSet], renderInfo, now, true);
+    }
+    bufferSets.release(bufferSet);
+}
+
+inline void TimewarpThreadLoop(threadpriority::Priority priority,
+                               std::uint64_t affinityMask,
+                               PresentBufferSets &bufferSets) {
+    if (!threadpriority::setCurrentThreadPriority(priority)) {
+        DebugLog("[OSVR Rendering Plugin] Could not set the timewarp thread "
+                 "priority.");
+    }
+    if (!threadpriority::setCurrentThreadAffinity(affinityMask)) {
+        DebugLog("[OSVR Rendering Plugin] Could not set the timewarp thread "
+                 "affinity.");
+    }
+    std::vector<osvr::renderkit::RenderInfo> renderInfo;
+    renderInfo.reserve(kMaxViews);
+    auto lastSubmitted = s_unityFramesSubmitted.load();
+    std::unique_lock<std::mutex> lock(s_timewarpStopMutex);
+    for (;;) {
+        const auto wakeUp =
+            std::chrono::steady_clock::now() + TimeUntilTimewarpCheck();
+        if (s_timewarpStopCondition.wait_until(
+                lock, wakeUp, [] { return s_timewarpStopRequested; })) {
+            break;
+        }
+        const auto submitted = s_unityFramesSubmitted.load();
+        if (submitted != lastSubmitted) {
+            lastSubmitted = submitted;
+            continue;
+        }
+        lock.unlock();
+        ReprojectLastFrame(bufferSets, renderInfo);
+        lock.lock();
+    }
+}
+
+/// Caller must hold s_timewarpThreadMutex.
+inline void StopTimewarpThreadLocked() {
+    if (s_timewarpThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(s_timewarpStopMutex);
+            s_timewarpStopRequested = true;
+        }
+        s_timewarpStopCondition.notify_all();
+        s_timewarpThread.join();
+        s_timewarpRunning = false;
+        DebugLog("[OSVR Rendering Plugin] Timewarp thread stopped.");
+    }
+    s_runningTimewarpModeGeneration = 0;
+}
+
+/// Caller must hold s_presentThreadMutex and s_timewarpThreadMutex.
+inline void StartTimewarpThreadLocked() {
+    if (!CanPresentOffRenderThread()) {
+        DebugLog("[OSVR Rendering Plugin] Timewarp thread only supported "
+                 "without a graphics device.");
+        return;
+    }
+    if (!CreatePresentBufferSetsLocked()) {
+        return;
+    }
+    threadpriority::Priority priority = threadpriority::Priority::High;
+    switch (s_requestedTimewarpPriority) {
+    case OSVR_UNITY_THREAD_PRIORITY_NORMAL:
+        priority = threadpriority::Priority::Normal;
+        break;
+    case OSVR_UNITY_THREAD_PRIORITY_REALTIME:
+        priority = threadpriority::Priority::Realtime;
+        break;
+    default:
+        break;
+    }
+    const std::uint64_t affinityMask = s_requestedTimewarpAffinity;
+    {
+        std::lock_guard<std::mutex> lock(s_timewarpStopMutex);
+        s_timewarpStopRequested = false;
+    }
+    auto &bufferSets = *s_presentBufferSets;
+    s_timewarpThread = std::thread([priority, affinityMask, &bufferSets] {
+        TimewarpThreadLoop(priority, affinityMask, bufferSets);
+    });
+    s_timewarpRunning = true;
+    DebugLog("[OSVR Rendering Plugin] Timewarp thread started.");
+}
+
+inline void StopTimewarpThread() {
+    std::lock_guard<std::mutex> lock(s_timewarpThreadMutex);
+    StopTimewarpThreadLocked();
+}
+
+/// Called on the render thread once there are buffers to present: starts,
+/// restarts or stops the timewarp thread to match the requested mode.
+inline void UpdateTimewarpThread() {
+    const auto generation = s_timewarpModeGeneration.load();
+    std::lock_guard<std::mutex> presentLock(s_presentThreadMutex);
+    std::lock_guard<std::mutex> lock(s_timewarpThreadMutex);
+    if (generation == s_runningTimewarpModeGeneration) {
+        return;
+    }
+    StopTimewarpThreadLocked();
+    s_runningTimewarpModeGeneration = generation;
+    if (s_requestedTimewarp) {
+        StartTimewarpThreadLocked();
+    }
+}
+
+void UNITY_INTERFACE_API SetTimewarpThreadMode(int enabled, int priority,
+                                               uint64_t affinityMask) {
+    s_requestedTimewarpPriority = priority;
+    s_requestedTimewarpAffinity = affinityMask;
+    s_requestedTimewarp = enabled != 0;
+    ++s_timewarpModeGeneration;
+}
+
+OSVR_ReturnCode UNITY_INTERFACE_API
+GetTimewarpStats(OSVR_UnityTimewarpStats *stats) {
+    if (stats == nullptr) {
+        return OSVR_RETURN_FAILURE;
+    }
+    // Every reprojected frame was counted as presented first.
+    const std::uint64_t reprojected = s_statFramesReprojected;
+    const std::uint64_t presented = s_statFramesPresented;
+    stats->running = s_timewarpRunning ? 1 : 0;
+    stats->framesFresh = presented - reprojected;
+    stats->framesReprojected = reprojected;
+    return OSVR_RETURN_SUCCESS;
+}
+
+/// Histograms record microseconds; the export is in milliseconds.
+inline OSVR_UnityLatencySummary
+SummarizeLatency(LatencyHistogram const &histogram) {
+    const auto s = histogram.summarize();
+    OSVR_UnityLatencySummary ret;
+    ret.count = s.count;
+    ret.p50Ms = s.p50 / 1e3;
+    ret.p95Ms = s.p95 / 1e3;
+    ret.p99Ms = s.p99 / 1e3;
+    ret.maxMs = s.max / 1e3;
+    return ret;
+}
+
+OSVR_ReturnCode UNITY_INTERFACE_API
+GetPluginFrameStats(OSVR_UnityPluginFrameStats *stats) {
+    if (stats == nullptr) {
+        return OSVR_RETURN_FAILURE;
+    }
+    stats->framesPresented = s_statFramesPresented;
+    stats->presentFailures = s_statPresentFailures;
+    stats->renderEvents = s_statRenderEvents;
+    stats->updatesSkipped = s_statUpdatesSkipped;
+    stats->presentDuration = SummarizeLatency(s_presentDurationHistogram);
+    stats->poseAgeAtPresent = SummarizeLatency(s_poseAgeAtPresentHistogram);
+    stats->updateToRender = SummarizeLatency(s_updateToRenderHistogram);
+    stats->predictionLeadSeconds = s_predictionLeadUs / 1e6;
+    return OSVR_RETURN_SUCCESS;
+}
+
+OSVR_ReturnCode UNITY_INTERFACE_API WriteFrameTrace(const char *path,
+                                                    double seconds) {
+#if defined(OSVR_UNITY_ENABLE_TRACING)
+    if (path != nullptr && frametrace::writeChromeTrace(path, seconds)) {
+        return OSVR_RETURN_SUCCESS;
+    }
+    DebugLog("[OSVR Rendering Plugin] Could not write the frame trace.");
+#else
+    (void)path;
+    (void)seconds;
+    DebugLog("[OSVR Rendering Plugin] Frame tracing was not compiled in.");
+#endif
+    return OSVR_RETURN_FAILURE;
+}
+
+/// Loads the latest render info into s_presentSnapshot and
+/// s_presentRenderInfo. Returns false if there's nothing to present.
+inline bool LoadPresentRenderInfo() {
+    // Present from an immutable copy of the latest render info, so that
+    // UpdateRenderInfo and the main-thread getters can proceed meanwhile.
+    s_lastRenderInfo.load(s_presentSnapshot);
+    if (s_presentSnapshot.provisional || s_renderBuffers.empty()) {
+        // Nothing real to present yet, or no buffers (e.g. mid device
+        // reset).
+        return false;
+    }
+    s_presentRenderInfo.assign(s_presentSnapshot.info.begin(),
+                               s_presentSnapshot.info.begin() +
+                                   s_presentSnapshot.count);
+    return true;
+}
+
 inline void DoRender() {
-    if (!s_deviceType) {
+    if (!s_deviceType || s_render == nullptr) {
+        return;
+    }
+    OSVR_TRACE_ZONE("DoRender");
+    ApplyPendingDistortion();
+    if (!LoadPresentRenderInfo()) {
         return;
     }
-	std::lock_guard<std::mutex> lock(m_mutex);
-    const auto n = static_cast<int>(s_lastRenderInfo.size());
+    // Side-by-side, every eye shares the first buffer, so it's only set up
+    // once. Render info may briefly report a different view count than the
+    // buffers were constructed for.
+    const auto n = static_cast<int>(
+        s_textureLayout == OSVR_UNITY_STEREO_TEXTURE_SIDE_BY_SIDE
+            ? std::min<std::size_t>(1, s_renderBuffers.size())
+            : std::min(s_presentRenderInfo.size(), s_renderBuffers.size()));
 
     switch (s_deviceType.getDeviceTypeEnum()) {
 #if SUPPORT_D3D11
     case OSVRSupportedRenderers::D3D11: {
-		// Render into each buffer using the specified information.
-		for (int i = 0; i < n; ++i) {
-			RenderViewD3D11(s_lastRenderInfo[i],
-				s_renderBuffers[i].D3D11->colorBufferView, i);
-		}
-
-        // Send the rendered results to the screen
-        // Flip Y because Unity RenderTextures are upside-down on D3D11
-        if (!s_render->PresentRenderBuffers(
-			s_renderBuffers, s_lastRenderInfo,
-                osvr::renderkit::RenderManager::RenderParams(),
-                std::vector<osvr::renderkit::OSVR_ViewportDescription>(),
-                true)) {
-            DebugLog("[OSVR Rendering Plugin] PresentRenderBuffers() returned "
-                     "false, maybe because it was asked to quit");
+        OSVR_TRACE_ZONE("RenderViewD3D11");
+        // Render into each buffer using the specified information.
+        for (int i = 0; i < n; ++i) {
+            RenderViewD3D11(s_presentRenderInfo[i],
+                            s_renderBuffers[i].D3D11->colorBufferView, i);
         }
         break;
     }
@@ -849,28 +2645,133 @@ inline void DoRender() {
 
 #if SUPPORT_OPENGL
     case OSVRSupportedRenderers::OpenGL: {
-        // OpenGL
-        //@todo OpenGL path is not working yet
-        // Render into each buffer using the specified information.
-
+        OSVR_TRACE_ZONE("RenderViewOpenGL");
         for (int i = 0; i < n; ++i) {
-            RenderViewOpenGL(s_renderInfo[i], s_frameBuffer,
-                             s_renderBuffers[i].OpenGL->colorBufferName, i);
-        }
-
-        // Send the rendered results to the screen
-        if (!s_render->PresentRenderBuffers(s_renderBuffers, s_renderInfo)) {
-            DebugLog("PresentRenderBuffers() returned false, maybe because "
-                     "it was asked to quit");
+            RenderViewOpenGL(i);
         }
         break;
     }
 #endif // SUPPORT_OPENGL
 
+    case OSVRSupportedRenderers::Null:
+        // Nothing to render into; just hand the frame to the backend.
+        break;
+
     case OSVRSupportedRenderers::EmptyRenderer:
     default:
-        break;
+        return;
     }
+
+    // Send the rendered results to the screen
+    ++s_unityFramesSubmitted;
+    s_lastSubmitNs = SteadyNowNs();
+    SubmitFrame();
+    UpdateTimewarpThread();
+}
+
+// --------------------------------------------------------------------------
+// Reprojection fallback
+//
+// Opt-in (SetReprojectionFallback), for when neither the timewarp thread nor
+// the present thread is running: each kOsvrEventID_Update works out from the
+// backend's vsync timing whether the next vsync will go without a new frame:
+// none submitted since the last vsync, and Unity's next one (going by how
+// long after an update it usually comes) too late to make it. If so, the
+// render thread presents the registered buffers again right away with the
+// render info just fetched, so RenderManager's timewarp reprojects the old
+// images instead of the display showing them unchanged.
+//
+// That present blocks the render thread until the vsync, holding up Unity's
+// next frame too, so it's skipped if that would make the frame miss the
+// vsync it would otherwise make: a fresh frame is never pushed back a
+// refresh by a reprojected one ahead of it.
+//
+// Only the render thread may present on Unity's context, so a stall that
+// stops it too (e.g. a garbage collection on Unity's main thread) goes
+// uncovered until the first update after it; where it runs, the timewarp
+// thread covers those.
+
+static std::atomic<bool> s_reprojectionFallback{false};
+/// Time a present needs before vsync to make it.
+static const std::int64_t kPresentMarginNs = 2000000;
+/// Render thread only: the vsync the fallback last presented for, when the
+/// last update was done and how long Unity's frame usually comes after that.
+static std::int64_t s_lastReprojectedVsyncNs = 0;
+static std::int64_t s_updateDoneNs = 0;
+static double s_updateToRenderEstimateNs = 0.;
+/// s_unityFramesSubmitted as of the previous kOsvrEventID_Update, for
+/// backends that can't tell when vsync is.
+static std::uint64_t s_framesSubmittedAtLastUpdate = 0;
+
+/// Whether to present the last frame again for the next vsync: it will go
+/// without a new frame from Unity, going by the backend's vsync timing, and
+/// presenting won't delay Unity's next frame to a later vsync. Without vsync
+/// timing, whether no frame came since the previous update. @p nextVsyncNs
+/// is set to the vsync in question, 0 if unknown.
+inline bool ShouldReprojectForNextVsync(bool submittedSinceUpdate,
+                                        std::int64_t &nextVsyncNs) {
+    nextVsyncNs = 0;
+    osvr::renderkit::RenderTimingInfo timing;
+    bool haveTiming;
+    {
+        std::lock_guard<std::mutex> lock(s_renderMutex);
+        haveTiming = s_render->GetTimingInfo(0, timing);
+    }
+    const std::int64_t interval =
+        haveTiming
+            ? ToMicroseconds(timing.hardwareDisplayInterval).count() * 1000
+            : 0;
+    if (interval <= 0) {
+        return !submittedSinceUpdate;
+    }
+    const auto now = SteadyNowNs();
+    const auto lastVsyncNs =
+        now -
+        ToMicroseconds(timing.timeSincelastVerticalRetrace).count() * 1000;
+    nextVsyncNs = lastVsyncNs + interval;
+    if (s_lastSubmitNs >= lastVsyncNs ||
+        s_lastReprojectedVsyncNs > lastVsyncNs + interval / 2) {
+        // The next vsync already has a frame, fresh or reprojected.
+        return false;
+    }
+    // The first vsync Unity's next frame makes if the render thread is
+    // held up @p delayNs first.
+    const auto estimateNs = static_cast<std::int64_t>(
+        s_updateToRenderEstimateNs + kPresentMarginNs);
+    auto vsyncMade = [&](std::int64_t delayNs) {
+        const auto sinceLastVsync = now + delayNs + estimateNs - lastVsyncNs;
+        return lastVsyncNs +
+               (sinceLastVsync + interval - 1) / interval * interval;
+    };
+    const auto vsyncIfNotPresenting = vsyncMade(0);
+    return vsyncIfNotPresenting > nextVsyncNs &&
+           vsyncMade(nextVsyncNs - now) == vsyncIfNotPresenting;
+}
+
+/// Called on the render thread after each render info update.
+inline void CheckForMissedFrame() {
+    const auto submitted = s_unityFramesSubmitted.load();
+    const bool submittedSinceUpdate =
+        submitted != s_framesSubmittedAtLastUpdate;
+    s_framesSubmittedAtLastUpdate = submitted;
+    // Presenting here would jump ahead of the frames the present thread
+    // still has queued.
+    std::int64_t nextVsyncNs;
+    if (submitted == 0 || !s_reprojectionFallback || s_timewarpRunning ||
+        s_presentThreadRunning || !s_deviceType || s_render == nullptr ||
+        !ShouldReprojectForNextVsync(submittedSinceUpdate, nextVsyncNs)) {
+        return;
+    }
+    OSVR_TRACE_ZONE("ReprojectMissedFrame");
+    if (LoadPresentRenderInfo()) {
+        PresentRenderInfo(s_renderBuffers, s_presentRenderInfo,
+                          s_presentSnapshot.timestamp, true);
+        s_lastReprojectedVsyncNs = nextVsyncNs;
+    }
+}
+
+void UNITY_INTERFACE_API SetReprojectionFallback(int enabled) {
+    s_reprojectionFallback = enabled != 0;
 }
 
 // --------------------------------------------------------------------------
@@ -884,16 +2785,36 @@ void UNITY_INTERFACE_API OnRenderEvent(int eventID) {
     if (!s_deviceType) {
         return;
     }
+    FinishCreateRenderManagerAsync();
 
     switch (eventID) {
     // Call the Render loop
-    case kOsvrEventID_Render:
+    case kOsvrEventID_Render: {
+        ++s_statRenderEvents;
+        const auto lastUpdate = s_lastUpdateEventNs.load();
+        const auto now = SteadyNowNs();
+        if (lastUpdate != 0) {
+            s_updateToRenderHistogram.record((now - lastUpdate) / 1e3);
+        }
+        if (s_updateDoneNs != 0) {
+            // Smoothed, for the reprojection fallback's guess at whether
+            // this frame's successor will make its vsync.
+            s_updateToRenderEstimateNs +=
+                (static_cast<double>(now - s_updateDoneNs) -
+                 s_updateToRenderEstimateNs) /
+                8.;
+            s_updateDoneNs = 0;
+        }
         DoRender();
         break;
+    }
     case kOsvrEventID_Shutdown:
         break;
     case kOsvrEventID_Update:
+        s_lastUpdateEventNs = SteadyNowNs();
         UpdateRenderInfo();
+        CheckForMissedFrame();
+        s_updateDoneNs = SteadyNowNs();
         break;
     case kOsvrEventID_SetRoomRotationUsingHead:
         SetRoomRotationUsingHead();
@@ -901,6 +2822,9 @@ void UNITY_INTERFACE_API OnRenderEvent(int eventID) {
     case kOsvrEventID_ClearRoomToWorldTransform:
         ClearRoomToWorldTransform();
         break;
+    case kOsvrEventID_Reconfigure:
+        ReconfigureRenderBuffers();
+        break;
     default:
         break;
     }
@@ -28,12 +28,216 @@ Sensics, Inc.
 #include <osvr/RenderKit/RenderKitGraphicsTransforms.h>
 #include <osvr/Util/ClientOpaqueTypesC.h>
 #include <osvr/Util/ReturnCodesC.h>
+#include <osvr/Util/TimeValueC.h>
+
+#include <stdint.h>
 
 typedef void(UNITY_INTERFACE_API *DebugFnPtr)(const char *);
 
-extern "C" {
+/// Everything the managed side needs to render one eye, as filled in by
+/// GetAllEyeRenderData.
+struct OSVR_UnityEyeRenderData {
+    OSVR_Pose3 pose;
+    osvr::renderkit::OSVR_ProjectionMatrix projection;
+    osvr::renderkit::OSVR_ViewportDescription viewport;
+};
+
+/// A single frustum enclosing the view frusta of all eyes, see
+/// GetCullingFrustum. Recomputed only when an eye pose or projection changes
+/// (so also after SetIPD, SetNearClipDistance or SetFarClipDistance).
+struct OSVR_UnityCullingFrustum {
+    /// Apex and orientation of the frustum, which looks down -Z like an eye
+    /// pose.
+    OSVR_Pose3 origin;
+    /// Extents at the near plane, as with GetProjectionMatrix.
+    osvr::renderkit::OSVR_ProjectionMatrix projection;
+    /// Left, right, bottom, top, near and far planes (a, b, c, d) in OSVR's
+    /// right-handed world space, that of the eye poses: unit normals point
+    /// inwards, so points inside have ax + by + cz + d >= 0.
+    double planes[6][4];
+    /// The same planes in Unity's left-handed world space (z negated, as
+    /// with GetEyeMatrices), for culling Unity world-space bounds.
+    double unityPlanes[6][4];
+    /// Of the render info it was computed from, as in
+    /// OSVR_UnityRenderDataHeader.
+    uint64_t generation;
+};
+
+/// Clip-space depth conventions for GetEyeMatrices.
+enum OSVR_UnityClipSpace {
+    /// -1 (near) to 1 (far): what Camera.projectionMatrix takes, whatever
+    /// the graphics API.
+    OSVR_UNITY_CLIP_SPACE_OPENGL = 0,
+    /// 0 (near) to 1 (far), for use directly as a Direct3D 11 projection.
+    OSVR_UNITY_CLIP_SPACE_D3D = 1,
+    /// 1 (near) to 0 (far), as Unity's Direct3D 11 renderer uses from 5.5.
+    OSVR_UNITY_CLIP_SPACE_D3D_REVERSED_Z = 2
+};
+
+/// One eye's matrices as Unity's Matrix4x4 holds them: column-major, for
+/// Unity's left-handed world, see GetEyeMatrices.
+struct OSVR_UnityEyeMatrices {
+    /// For Camera.worldToCameraMatrix.
+    float view[16];
+    float projection[16];
+};
+
+/// Backends that CreateRenderManagerFromUnity can create, see SetRenderBackend.
+enum OSVR_UnityRenderBackend {
+    /// A real OSVR RenderManager (the default).
+    OSVR_UNITY_RENDER_BACKEND_RENDERMANAGER = 0,
+    /// A built-in mock that needs neither a server nor a GPU, for testing
+    /// and benchmarking the plugin itself.
+    OSVR_UNITY_RENDER_BACKEND_MOCK = 1
+};
+
+/// What the mock render backend has been asked to do so far.
+struct OSVR_UnityMockRenderBackendStats {
+    uint64_t presentCount;
+    int32_t registeredBufferCount;
+    /// Number of RegisterRenderBuffers calls.
+    uint64_t registerCount;
+    /// OpenGL texture names of the first registered buffers, as the last
+    /// RegisterRenderBuffers call got them (0 without OpenGL).
+    uint32_t registeredTextureNames[8];
+    int32_t lastPresentedBufferCount;
+    /// Normalized cropping viewports passed with the last present (0 means
+    /// each eye presents its whole buffer).
+    int32_t lastCroppingViewportCount;
+};
+
+/// What the present thread does when Unity renders faster than frames can be
+/// presented, see SetPresentThreadMode.
+enum OSVR_UnityPresentQueuePolicy {
+    /// The render event waits for room in the queue (back-pressure).
+    OSVR_UNITY_PRESENT_QUEUE_BLOCK = 0,
+    /// The oldest queued frame is dropped to make room.
+    OSVR_UNITY_PRESENT_QUEUE_DROP_OLDEST = 1
+};
+
+/// Present thread counters, see GetPresentQueueStats.
+struct OSVR_UnityPresentQueueStats {
+    /// Frames queued or being presented right now.
+    int32_t queueDepth;
+    int32_t maxFramesInFlight;
+    uint64_t framesEnqueued;
+    uint64_t framesPresented;
+    uint64_t framesDropped;
+};
+
+/// Percentiles of one latency distribution, in milliseconds. Values are
+/// bucketed, so they're accurate to about 12%.
+struct OSVR_UnityLatencySummary {
+    uint64_t count;
+    double p50Ms;
+    double p95Ms;
+    double p99Ms;
+    double maxMs;
+};
+
+/// Running counters and latency distributions since plugin load, see
+/// GetPluginFrameStats.
+struct OSVR_UnityPluginFrameStats {
+    uint64_t framesPresented;
+    /// Frames for which PresentRenderBuffers returned false.
+    uint64_t presentFailures;
+    /// kOsvrEventID_Render events received.
+    uint64_t renderEvents;
+    /// Render info updates that found no backend or got no render info.
+    uint64_t updatesSkipped;
+    /// Time spent in PresentRenderBuffers.
+    OSVR_UnityLatencySummary presentDuration;
+    /// Age of the poses being presented when presenting starts.
+    OSVR_UnityLatencySummary poseAgeAtPresent;
+    /// Time from the last kOsvrEventID_Update to each kOsvrEventID_Render.
+    OSVR_UnityLatencySummary updateToRender;
+    /// How far ahead the last render info update predicted the poses (0 if
+    /// pose prediction is off), see SetPosePrediction.
+    double predictionLeadSeconds;
+};
+
+/// How Unity lays out the eye images, see SetStereoTextureLayout.
+enum OSVR_UnityStereoTextureLayout {
+    /// One texture per eye, each set with SetColorBufferFromUnity (default).
+    OSVR_UNITY_STEREO_TEXTURE_PER_EYE = 0,
+    /// All eyes side by side, left to right in equal columns, in the one
+    /// texture set for eye 0 (as with Unity's single-pass stereo).
+    OSVR_UNITY_STEREO_TEXTURE_SIDE_BY_SIDE = 1,
+    /// One slice per eye of the texture array set for eye 0 (as with Unity's
+    /// single-pass instanced stereo). OpenGL needs ARB_texture_view, and
+    /// ConstructRenderBuffers must be called again if the array is replaced.
+    /// OpenGL hands RenderManager views of the slices, but RenderManager
+    /// only takes plain 2D textures on Direct3D 11, so there each slice is
+    /// copied (on the GPU) into a texture of its own every frame: one eye
+    /// image's worth of extra read and write per eye, e.g. about 10 MB each
+    /// way per eye at 1512x1680 RGBA8.
+    OSVR_UNITY_STEREO_TEXTURE_ARRAY = 2
+};
+
+/// Describes the render info snapshot GetAllEyeRenderData read from.
+struct OSVR_UnityRenderDataHeader {
+    /// Incremented every time new render info is published.
+    uint64_t generation;
+    /// When the render info was fetched from RenderManager.
+    OSVR_TimeValue timestamp;
+    /// Number of eyes in the snapshot (may exceed the number written).
+    int32_t eyeCount;
+    /// Nonzero if the viewports and projections are from the warm-start
+    /// cache written by an earlier run (loaded at plugin load), rather than
+    /// from RenderManager. Poses are identity until then.
+    int32_t provisional;
+};
+
+/// Progress of creating RenderManager, see GetRenderManagerStatus.
+enum OSVR_UnityRenderManagerStatus {
+    /// Not created (or shut down).
+    OSVR_UNITY_RENDER_MANAGER_NONE = 0,
+    /// CreateRenderManagerFromUnityAsync is still working.
+    OSVR_UNITY_RENDER_MANAGER_PENDING = 1,
+    /// Created with its display open; construct the render buffers next.
+    OSVR_UNITY_RENDER_MANAGER_READY = 2,
+    /// Creation failed; GetRenderManagerStatus says why.
+    OSVR_UNITY_RENDER_MANAGER_FAILED = 3
+};
+
+/// Scheduling priority of a plugin-owned thread, see SetTimewarpThreadMode.
+enum OSVR_UnityThreadPriority {
+    OSVR_UNITY_THREAD_PRIORITY_NORMAL = 0,
+    OSVR_UNITY_THREAD_PRIORITY_HIGH = 1,
+    /// Real-time scheduling where the OS allows it (on Linux this usually
+    /// needs CAP_SYS_NICE).
+    OSVR_UNITY_THREAD_PRIORITY_REALTIME = 2
+};
 
-// No apparent UpdateDistortionMeshes symbol found?
+/// Timewarp thread counters, see GetTimewarpStats.
+struct OSVR_UnityTimewarpStats {
+    /// Nonzero while the timewarp thread is running.
+    int32_t running;
+    /// Frames rendered by Unity that were presented.
+    uint64_t framesFresh;
+    /// Frames presented again, with a fresh pose, because Unity had not
+    /// submitted a new one in time (by the timewarp thread or the
+    /// reprojection fallback).
+    uint64_t framesReprojected;
+};
+
+/// One eye's lens distortion for UpdateDistortionMesh, in the terms of
+/// RenderManager's rgb_symmetric_polynomials: offsets from the center of
+/// projection, divided by the distance scale, have their length mapped
+/// through a polynomial per color. Coordinates are normalized (0 to 1).
+struct OSVR_UnityDistortionParameters {
+    float centerOfProjection[2];
+    float distanceScale[2];
+    /// Red, green and blue coefficients, lowest order first; only read
+    /// during the call.
+    const float *polynomial[3];
+    int32_t polynomialLength[3];
+};
+
+/// Receives an OSVR_UnityRenderManagerStatus.
+typedef void(UNITY_INTERFACE_API *OSVR_UnityRenderManagerStatusFnPtr)(int);
+
+extern "C" {
 
 /// @todo These are all the exported symbols, and they all are decorated to use
 /// stdcall - yet somehow the managed code refers to some as cdecl. Either those
@@ -45,8 +249,85 @@ ConstructRenderBuffers();
 UNITY_INTERFACE_EXPORT OSVR_ReturnCode UNITY_INTERFACE_API
 CreateRenderManagerFromUnity(OSVR_ClientContext context);
 
+/// Like CreateRenderManagerFromUnity, but returns right away: RenderManager
+/// is created and its display opened on a background thread (with OpenGL, on
+/// the render thread at the next render event). At the first render event
+/// after that, the render thread takes it over and the status becomes ready
+/// or failed. Poll GetRenderManagerStatus, or pass a @p callback (may be
+/// null), which is called on the render thread with the final status. Once
+/// ready, set the eye textures and call ConstructRenderBuffers, as after
+/// CreateRenderManagerFromUnity.
+UNITY_INTERFACE_EXPORT OSVR_ReturnCode UNITY_INTERFACE_API
+CreateRenderManagerFromUnityAsync(OSVR_ClientContext context,
+                                  OSVR_UnityRenderManagerStatusFnPtr callback);
+
+/// Fills up to @p maxEyes entries of @p eyes (and @p header, if not null)
+/// from a single coherent render info snapshot. Returns the number of eyes in
+/// that snapshot.
+UNITY_INTERFACE_EXPORT int UNITY_INTERFACE_API
+GetAllEyeRenderData(OSVR_UnityEyeRenderData *eyes, int maxEyes,
+                    OSVR_UnityRenderDataHeader *header);
+
+/// Fills @p frustum with a frustum enclosing the view frusta of all eyes in
+/// the latest render info, so one culling pass can serve them all. Fails if
+/// there is no render info from RenderManager yet.
+UNITY_INTERFACE_EXPORT OSVR_ReturnCode UNITY_INTERFACE_API
+GetCullingFrustum(OSVR_UnityCullingFrustum *frustum);
+
+/// Like GetAllEyeRenderData, but with each eye's pose and projection already
+/// converted to Unity's conventions: the view matrix takes Unity world
+/// space (left-handed) to the eye's camera space, and the projection maps
+/// depth to @p clipSpace (an OSVR_UnityClipSpace) without flipping y.
+/// Returns the number of eyes in the snapshot, or -1 for an unknown
+/// @p clipSpace.
+UNITY_INTERFACE_EXPORT int UNITY_INTERFACE_API
+GetEyeMatrices(OSVR_UnityEyeMatrices *eyes, int maxEyes, int clipSpace,
+               OSVR_UnityRenderDataHeader *header);
+
 UNITY_INTERFACE_EXPORT OSVR_Pose3 UNITY_INTERFACE_API GetEyePose(int eye);
 
+/// The pose of eye @p eye at @p time (on the osvrTimeValueGetNow clock),
+/// from a history of the poses fetched by the last few seconds of Update
+/// events: interpolated between the two around @p time, extrapolated from
+/// the newest two by at most 50 ms, or the oldest one for earlier times.
+/// Lock-free, so it can be called from any thread. Fails if there is no
+/// pose for that eye yet.
+UNITY_INTERFACE_EXPORT OSVR_ReturnCode UNITY_INTERFACE_API
+GetEyePoseAtTime(int eye, OSVR_TimeValue time, OSVR_Pose3 *pose);
+
+/// Triangles covering the part of eye @p eye's image that the distortion
+/// from the last UpdateDistortionMesh never shows, so it can be stenciled
+/// or depth-primed out before shading. Vertices are (x, y) pairs in
+/// normalized viewport coordinates (0 to 1, origin bottom left); triangles
+/// have no particular winding. Always sets @p vertexCount and @p indexCount
+/// (if not null); pass null buffers to query just those. Fails if there is
+/// no mesh for that eye or the buffers are too small.
+///
+/// Only available after a successful UpdateDistortionMesh: the plugin can't
+/// see the distortion RenderManager configures from the display descriptor
+/// on its own, so with that distortion (the default) this always fails.
+UNITY_INTERFACE_EXPORT OSVR_ReturnCode UNITY_INTERFACE_API
+GetHiddenAreaMesh(int eye, float *vertices, int maxVertices, int32_t *indices,
+                  int maxIndices, int32_t *vertexCount, int32_t *indexCount);
+
+/// Only succeeds while the mock render backend is in use.
+UNITY_INTERFACE_EXPORT OSVR_ReturnCode UNITY_INTERFACE_API
+GetMockRenderBackendStats(OSVR_UnityMockRenderBackendStats *stats);
+
+/// Cheap enough to poll every frame: only reads atomics, never blocks the
+/// render thread.
+UNITY_INTERFACE_EXPORT OSVR_ReturnCode UNITY_INTERFACE_API
+GetPluginFrameStats(OSVR_UnityPluginFrameStats *stats);
+
+UNITY_INTERFACE_EXPORT OSVR_ReturnCode UNITY_INTERFACE_API
+GetPresentQueueStats(OSVR_UnityPresentQueueStats *stats);
+
+/// Returns the OSVR_UnityRenderManagerStatus of the last creation attempt.
+/// If it failed, the reason is copied into @p failureReason (may be null),
+/// truncated to @p failureReasonSize bytes including the terminator.
+UNITY_INTERFACE_EXPORT int UNITY_INTERFACE_API
+GetRenderManagerStatus(char *failureReason, int failureReasonSize);
+
 UNITY_INTERFACE_EXPORT osvr::renderkit::OSVR_ProjectionMatrix
     UNITY_INTERFACE_API
     GetProjectionMatrix(int eye);
@@ -54,6 +335,13 @@ UNITY_INTERFACE_EXPORT osvr::renderkit::OSVR_ProjectionMatrix
 UNITY_INTERFACE_EXPORT UnityRenderingEvent UNITY_INTERFACE_API
 GetRenderEventFunc();
 
+UNITY_INTERFACE_EXPORT OSVR_ReturnCode UNITY_INTERFACE_API
+GetTimewarpStats(OSVR_UnityTimewarpStats *stats);
+
+/// Number of views (eyes) in the latest render info; may be more than two,
+/// up to the plugin's limit of 8.
+UNITY_INTERFACE_EXPORT int UNITY_INTERFACE_API GetViewCount();
+
 UNITY_INTERFACE_EXPORT osvr::renderkit::OSVR_ViewportDescription
     UNITY_INTERFACE_API
     GetViewport(int eye);
@@ -62,15 +350,84 @@ UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API LinkDebug(DebugFnPtr d);
 
 UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API OnRenderEvent(int eventID);
 
+/// Sets the texture for view @p eye (0 to GetViewCount() - 1). In the
+/// side-by-side and texture array layouts, only eye 0 is used.
 /// @todo should return OSVR_ReturnCode
 UNITY_INTERFACE_EXPORT int UNITY_INTERFACE_API
 SetColorBufferFromUnity(void *texturePtr, int eye);
 
+/// UpdateDistortionMesh keeps the meshes it generates in the temp directory,
+/// keyed by a hash of its arguments, and maps them back in instead of
+/// generating them again. On by default; pass 0 to always generate.
+UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API
+SetDistortionMeshCache(int enabled);
+
 UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API
 SetFarClipDistance(double distance);
 
 UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API SetIPD(double ipdMeters);
 
+/// Simulated display refresh rate for the mock backend (0 for no vsync
+/// wait). Takes effect at the next CreateRenderManagerFromUnity.
+UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API
+SetMockRenderBackendRefreshRate(double refreshRateHz);
+
+/// Opt-in: with @p enabled nonzero, each render info update moves the eye
+/// poses ahead by @p leadSeconds, at the velocity they moved with over the
+/// last 20 ms, so they match when the frame is displayed. A negative
+/// @p leadSeconds uses the measured time from fetching the poses to
+/// presenting them, plus half a refresh. The lead is capped at 100 ms.
+/// Frames presented again (timewarp, the reprojection fallback) are
+/// predicted the same way. GetEyePoseAtTime still returns the poses as
+/// measured.
+UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API
+SetPosePrediction(int enabled, double leadSeconds);
+
+/// Opt-in: with @p maxFramesInFlight > 0, kOsvrEventID_Render only queues
+/// the frame and a plugin-owned thread presents it. @p queuePolicy is an
+/// OSVR_UnityPresentQueuePolicy. Pass 0 to go back to presenting on the
+/// render thread. Only available without a graphics device (e.g. with the
+/// mock backend), whose buffers hold no images: with D3D11 and OpenGL,
+/// RenderManager presents on Unity's own context, and queued frames would
+/// need copies of the eye textures, which aren't implemented.
+UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API
+SetPresentThreadMode(int maxFramesInFlight, int queuePolicy);
+
+/// Selects the OSVR_UnityRenderBackend used by the next
+/// CreateRenderManagerFromUnity call.
+UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API SetRenderBackend(int backend);
+
+/// Opt-in: with @p enabled nonzero, a kOsvrEventID_Update that finds, from
+/// the backend's vsync timing, that the next vsync will go without a new
+/// frame from Unity presents the last eye buffers again, with the fresh
+/// pose, on the render thread. It doesn't if that would hold up Unity's next
+/// frame past the vsync it would otherwise make. Without vsync timing, it
+/// presents if Unity didn't present a frame since the previous update. Can't
+/// cover stalls that stop Unity's render thread too, such as a garbage
+/// collection. Does nothing while the timewarp thread
+/// (SetTimewarpThreadMode) or the present thread (SetPresentThreadMode) is
+/// running.
+UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API
+SetReprojectionFallback(int enabled);
+
+/// Selects an OSVR_UnityStereoTextureLayout. Takes effect at the next
+/// ConstructRenderBuffers.
+UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API
+SetStereoTextureLayout(int layout);
+
+/// Opt-in timewarp thread: with @p enabled nonzero, a plugin-owned thread
+/// wakes shortly before each vsync and, if Unity hasn't submitted a frame
+/// since the last one, presents a copy of the last complete frame again
+/// with a fresh pose. @p priority is an OSVR_UnityThreadPriority;
+/// @p affinityMask pins the thread to the CPUs whose bits are set (0 for any
+/// CPU). Takes effect at the next kOsvrEventID_Render. Like
+/// SetPresentThreadMode, only available without a graphics device: with
+/// D3D11 and OpenGL, RenderManager presents on the context of Unity's render
+/// thread, so this is not asynchronous timewarp there; use
+/// SetReprojectionFallback instead.
+UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API
+SetTimewarpThreadMode(int enabled, int priority, uint64_t affinityMask);
+
 UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API
 SetNearClipDistance(double distance);
 UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API ShutdownRenderManager();
@@ -78,8 +435,19 @@ UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API ShutdownRenderManager();
 UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API
 UnityPluginLoad(IUnityInterfaces *unityInterfaces);
 
+/// Writes the timing zones recorded in the last @p seconds to @p path as
+/// Chrome trace-event JSON (load it in chrome://tracing). Fails if the plugin
+/// was built without ENABLE_FRAME_TRACE.
+UNITY_INTERFACE_EXPORT OSVR_ReturnCode UNITY_INTERFACE_API
+WriteFrameTrace(const char *path, double seconds);
+
 UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UnityPluginUnload();
 
-// UpdateDistortionMesh no longer exported - buggy, not used.
+/// Generates distortion meshes of at least @p desiredTriangles triangles for
+/// @p eyeCount eyes. They replace the distortion from RenderManager's
+/// configuration at the next kOsvrEventID_Render.
+UNITY_INTERFACE_EXPORT OSVR_ReturnCode UNITY_INTERFACE_API
+UpdateDistortionMesh(const OSVR_UnityDistortionParameters *eyes, int eyeCount,
+                     int desiredTriangles);
 
 } // extern "C"
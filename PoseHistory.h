@@ -0,0 +1,268 @@
+/** @file
+    @brief Header
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Sensics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_PoseHistory_h_GUID_B72E4D19_0A6C_4F38_9D51_E6C3A8F2047B
+#define INCLUDED_PoseHistory_h_GUID_B72E4D19_0A6C_4F38_9D51_E6C3A8F2047B
+
+// Internal Includes
+#include "SeqLock.h"
+
+// Library/third-party includes
+#include <osvr/Util/Pose3C.h>
+
+// Standard includes
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace posehistory {
+
+/// Interpolates between two poses: linearly for the translation, along the
+/// shorter great arc for the rotation (w, x, y, z). @p u beyond [0, 1]
+/// extrapolates along the same line and arc.
+inline OSVR_PoseState interpolate(OSVR_PoseState const &a,
+                                  OSVR_PoseState const &b, double u) {
+    OSVR_PoseState ret;
+    for (int i = 0; i < 3; ++i) {
+        ret.translation.data[i] =
+            a.translation.data[i] +
+            u * (b.translation.data[i] - a.translation.data[i]);
+    }
+    auto const &qa = a.rotation.data;
+    double qb[4] = {b.rotation.data[0], b.rotation.data[1],
+                    b.rotation.data[2], b.rotation.data[3]};
+    double cosAngle =
+        qa[0] * qb[0] + qa[1] * qb[1] + qa[2] * qb[2] + qa[3] * qb[3];
+    if (cosAngle < 0.) {
+        cosAngle = -cosAngle;
+        for (auto &c : qb) {
+            c = -c;
+        }
+    }
+    double wa = 1. - u;
+    double wb = u;
+    // Close enough for a straight line (normalized below) to do.
+    if (cosAngle < 0.9995) {
+        const double angle = std::acos(std::min(cosAngle, 1.));
+        const double sinAngle = std::sin(angle);
+        wa = std::sin((1. - u) * angle) / sinAngle;
+        wb = std::sin(u * angle) / sinAngle;
+    }
+    double norm2 = 0.;
+    for (int i = 0; i < 4; ++i) {
+        ret.rotation.data[i] = wa * qa[i] + wb * qb[i];
+        norm2 += ret.rotation.data[i] * ret.rotation.data[i];
+    }
+    if (norm2 > 0.) {
+        const double inv = 1. / std::sqrt(norm2);
+        for (auto &c : ret.rotation.data) {
+            c *= inv;
+        }
+    }
+    return ret;
+}
+
+/// A ring of the most recent timestamped sets of view poses, for looking up
+/// the pose at an arbitrary time.
+///
+/// One writer (serialize calls to push() externally) and any number of
+/// readers: each slot is its own SeqLock, so sample() never blocks and
+/// never takes a lock. It finds the entries around the requested time with
+/// a binary search and starts over if the writer laps it meanwhile.
+template <std::size_t MaxViews, std::size_t Capacity = 256>
+class PoseHistory {
+  public:
+    /// Appends poses at @p timeUs (microseconds on any clock, as long as
+    /// sample() uses the same one). Poses at the same time as the newest
+    /// entry (the same tracker report read again) replace it. Time going
+    /// backwards, as a wall clock can, drops the older history.
+    void push(std::int64_t timeUs, const OSVR_PoseState *poses,
+              std::size_t count) {
+        const auto head = head_.load(std::memory_order_relaxed);
+        const bool replace = head > begin_.load(std::memory_order_relaxed) &&
+                             timeUs == lastTimeUs_;
+        const auto index = replace ? head - 1 : head;
+        if (head > 0 && timeUs < lastTimeUs_) {
+            begin_.store(index, std::memory_order_release);
+        }
+        lastTimeUs_ = timeUs;
+        Entry e;
+        e.index = index;
+        e.timeUs = timeUs;
+        e.count = std::min(count, MaxViews);
+        std::copy_n(poses, e.count, e.poses.begin());
+        slots_[index % Capacity].store(e);
+        head_.store(index + 1, std::memory_order_release);
+    }
+
+    /// The pose of view @p view at @p timeUs: interpolated between the
+    /// entries around it, the oldest entry's if it is older than the
+    /// history, or extrapolated from the last two entries (by at most
+    /// @p maxExtrapolationUs) if it is newer. Returns false if there is no
+    /// entry with that view. If @p outTimeUs is given, it is set to the time
+    /// the returned pose is actually for (e.g. the oldest entry's).
+    bool sample(std::size_t view, std::int64_t timeUs,
+                std::int64_t maxExtrapolationUs, OSVR_PoseState &out,
+                std::int64_t *outTimeUs = nullptr) const {
+        for (;;) {
+            const auto head = head_.load(std::memory_order_acquire);
+            const auto begin = std::max(
+                begin_.load(std::memory_order_acquire),
+                head > Capacity ? head - Capacity : std::uint64_t(0));
+            if (head == begin) {
+                return false;
+            }
+            // Find the newest entry at or before timeUs.
+            std::int64_t entryTime;
+            if (!readTime(begin, entryTime)) {
+                continue;
+            }
+            if (timeUs <= entryTime) {
+                Entry e;
+                if (!readEntry(begin, e)) {
+                    continue;
+                }
+                return poseAt(e, view, out, outTimeUs);
+            }
+            auto lo = begin;
+            auto hi = head - 1;
+            bool lapped = false;
+            while (lo < hi) {
+                const auto mid = lo + (hi - lo + 1) / 2;
+                if (!readTime(mid, entryTime)) {
+                    lapped = true;
+                    break;
+                }
+                if (entryTime <= timeUs) {
+                    lo = mid;
+                } else {
+                    hi = mid - 1;
+                }
+            }
+            if (lapped) {
+                continue;
+            }
+            // Interpolate between lo and lo + 1, or extrapolate from the
+            // last two entries.
+            const auto first = lo + 1 < head ? lo : (lo > begin ? lo - 1 : lo);
+            Entry a;
+            Entry b;
+            if (!readEntry(first, a) ||
+                (first + 1 < head && !readEntry(first + 1, b))) {
+                continue;
+            }
+            if (first + 1 >= head || view >= b.count) {
+                return poseAt(a, view, out, outTimeUs);
+            }
+            if (view >= a.count) {
+                return poseAt(b, view, out, outTimeUs);
+            }
+            const auto limit = b.timeUs + std::max<std::int64_t>(
+                                              maxExtrapolationUs, 0);
+            const auto sampledTimeUs = std::min(timeUs, limit);
+            const double u = static_cast<double>(sampledTimeUs - a.timeUs) /
+                             static_cast<double>(b.timeUs - a.timeUs);
+            out = interpolate(a.poses[view], b.poses[view], u);
+            if (outTimeUs != nullptr) {
+                *outTimeUs = sampledTimeUs;
+            }
+            return true;
+        }
+    }
+
+  private:
+    struct Entry {
+        /// Position in the ring, to detect readers being lapped.
+        std::uint64_t index;
+        std::int64_t timeUs;
+        std::size_t count;
+        std::array<OSVR_PoseState, MaxViews> poses;
+    };
+
+    static bool poseAt(Entry const &e, std::size_t view, OSVR_PoseState &out,
+                       std::int64_t *outTimeUs) {
+        if (view >= e.count) {
+            return false;
+        }
+        out = e.poses[view];
+        if (outTimeUs != nullptr) {
+            *outTimeUs = e.timeUs;
+        }
+        return true;
+    }
+
+    /// False if the slot no longer holds entry @p index.
+    bool readTime(std::uint64_t index, std::int64_t &timeUs) const {
+        const auto entry = slots_[index % Capacity].read([](Entry const &e) {
+            return std::make_pair(e.index, e.timeUs);
+        });
+        timeUs = entry.second;
+        return entry.first == index;
+    }
+
+    bool readEntry(std::uint64_t index, Entry &e) const {
+        slots_[index % Capacity].load(e);
+        return e.index == index;
+    }
+
+    std::array<SeqLock<Entry>, Capacity> slots_;
+    /// Number of entries ever pushed.
+    std::atomic<std::uint64_t> head_{0};
+    /// Entries before this one are from before the clock went backwards.
+    std::atomic<std::uint64_t> begin_{0};
+    /// Writer-only.
+    std::int64_t lastTimeUs_ = 0;
+};
+
+/// Constant-velocity prediction: where view @p view, at @p current as of
+/// @p nowUs, will be @p leadUs later, going by how it moved since the pose
+/// in @p history @p windowUs before @p nowUs (or the oldest one, if the
+/// history is shorter than that). Returns @p current if the history has no
+/// pose of that view, or none at least a quarter window older than
+/// @p nowUs to measure a velocity against.
+template <std::size_t MaxViews, std::size_t Capacity>
+inline OSVR_PoseState predict(PoseHistory<MaxViews, Capacity> const &history,
+                              std::size_t view, std::int64_t nowUs,
+                              OSVR_PoseState const &current,
+                              std::int64_t windowUs, std::int64_t leadUs) {
+    OSVR_PoseState past;
+    std::int64_t pastUs;
+    if (windowUs <= 0 ||
+        !history.sample(view, nowUs - windowUs, 0, past, &pastUs)) {
+        return current;
+    }
+    const auto elapsedUs = nowUs - pastUs;
+    if (elapsedUs < windowUs / 4) {
+        return current;
+    }
+    return interpolate(past, current,
+                       1. + static_cast<double>(leadUs) / elapsedUs);
+}
+} // namespace posehistory
+
+#endif // INCLUDED_PoseHistory_h_GUID_B72E4D19_0A6C_4F38_9D51_E6C3A8F2047B
@@ -0,0 +1,130 @@
+/** @file
+    @brief Header
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Sensics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RenderBackend_h_GUID_3A7D1E52_96C4_4B08_8F21_D54E0B7C6A93
+#define INCLUDED_RenderBackend_h_GUID_3A7D1E52_96C4_4B08_8F21_D54E0B7C6A93
+
+// Internal Includes
+// - none
+
+// Library/third-party includes
+#include <osvr/RenderKit/RenderManager.h>
+
+// Standard includes
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/// The subset of osvr::renderkit::RenderManager that the plugin uses, so that
+/// something other than a real RenderManager (see MockRenderBackend) can sit
+/// behind the plugin.
+class RenderBackend {
+  public:
+    typedef osvr::renderkit::RenderManager RenderManager;
+    typedef osvr::renderkit::RenderBuffer RenderBuffer;
+    typedef osvr::renderkit::RenderInfo RenderInfo;
+    typedef osvr::renderkit::OSVR_ViewportDescription ViewportDescription;
+    typedef osvr::renderkit::RenderTimingInfo RenderTimingInfo;
+
+    virtual ~RenderBackend() {}
+
+    virtual bool doingOkay() = 0;
+    virtual RenderManager::OpenResults OpenDisplay() = 0;
+    /// Fills @p renderInfo with the current render info; leaves it empty on
+    /// failure. MockRenderBackend reuses its storage, but RenderManager only
+    /// hands out a new vector, so RenderManagerBackend allocates every call.
+    virtual void GetRenderInfo(const RenderManager::RenderParams &params,
+                               std::vector<RenderInfo> &renderInfo) = 0;
+    virtual bool
+    RegisterRenderBuffers(const std::vector<RenderBuffer> &buffers) = 0;
+    virtual bool PresentRenderBuffers(
+        const std::vector<RenderBuffer> &buffers,
+        const std::vector<RenderInfo> &renderInfoUsed,
+        const RenderManager::RenderParams &renderParams,
+        const std::vector<ViewportDescription> &normalizedCroppingViewports,
+        bool flipInY) = 0;
+    /// Vsync timing of the display showing @p whichEye; returns false if it
+    /// isn't available.
+    virtual bool GetTimingInfo(std::size_t whichEye,
+                               RenderTimingInfo &info) = 0;
+    virtual bool UpdateDistortionMeshes(
+        RenderManager::DistortionMeshType type,
+        std::vector<RenderManager::DistortionParameters> const &distort) = 0;
+    virtual void SetRoomRotationUsingHead() = 0;
+    virtual void ClearRoomToWorldTransform() = 0;
+};
+
+/// The real thing: forwards everything to an osvr::renderkit::RenderManager,
+/// which it owns.
+class RenderManagerBackend : public RenderBackend {
+  public:
+    explicit RenderManagerBackend(RenderManager *render) : render_(render) {}
+
+    bool doingOkay() override { return render_->doingOkay(); }
+    RenderManager::OpenResults OpenDisplay() override {
+        return render_->OpenDisplay();
+    }
+    void GetRenderInfo(const RenderManager::RenderParams &params,
+                       std::vector<RenderInfo> &renderInfo) override {
+        // RenderManager only hands out a fresh vector, so this allocates
+        // inside RenderManager every frame; moving it in at least avoids a
+        // copy.
+        renderInfo = render_->GetRenderInfo(params);
+    }
+    bool
+    RegisterRenderBuffers(const std::vector<RenderBuffer> &buffers) override {
+        return render_->RegisterRenderBuffers(buffers);
+    }
+    bool PresentRenderBuffers(
+        const std::vector<RenderBuffer> &buffers,
+        const std::vector<RenderInfo> &renderInfoUsed,
+        const RenderManager::RenderParams &renderParams,
+        const std::vector<ViewportDescription> &normalizedCroppingViewports,
+        bool flipInY) override {
+        return render_->PresentRenderBuffers(buffers, renderInfoUsed,
+                                             renderParams,
+                                             normalizedCroppingViewports,
+                                             flipInY);
+    }
+    bool GetTimingInfo(std::size_t whichEye, RenderTimingInfo &info) override {
+        return render_->GetTimingInfo(whichEye, info);
+    }
+    bool UpdateDistortionMeshes(
+        RenderManager::DistortionMeshType type,
+        std::vector<RenderManager::DistortionParameters> const &distort)
+        override {
+        return render_->UpdateDistortionMeshes(type, distort);
+    }
+    void SetRoomRotationUsingHead() override {
+        render_->SetRoomRotationUsingHead();
+    }
+    void ClearRoomToWorldTransform() override {
+        render_->ClearRoomToWorldTransform();
+    }
+
+  private:
+    std::unique_ptr<RenderManager> render_;
+};
+
+#endif // INCLUDED_RenderBackend_h_GUID_3A7D1E52_96C4_4B08_8F21_D54E0B7C6A93
@@ -0,0 +1,172 @@
+/** @file
+    @brief Header
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Sensics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_RenderInfoCache_h_GUID_6E1B9C47_A2D0_4F35_8C6E_0B7D45A93F18
+#define INCLUDED_RenderInfoCache_h_GUID_6E1B9C47_A2D0_4F35_8C6E_0B7D45A93F18
+
+// Internal Includes
+// - none
+
+// Library/third-party includes
+#include <osvr/RenderKit/RenderKitGraphicsTransforms.h>
+
+// Standard includes
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+/// @name Warm-start cache
+///
+/// A small binary file holding the viewports and projections of the last
+/// display the plugin ran on, so they can be handed to Unity at plugin load,
+/// long before RenderManager is up. The file is written in native byte order
+/// and is only meant to be read back on the same machine; anything that
+/// doesn't check out is ignored.
+/// @{
+
+namespace renderinfocache {
+
+struct CachedView {
+    osvr::renderkit::OSVR_ViewportDescription viewport;
+    osvr::renderkit::OSVR_ProjectionMatrix projection;
+};
+
+static const std::uint32_t kMagic = 0x4f535655; // "OSVU"
+static const std::uint32_t kVersion = 1;
+static const std::size_t kMaxViews = 8;
+
+struct File {
+    std::uint32_t magic;
+    std::uint32_t version;
+    /// Identifies the display configuration, see hashString().
+    std::uint64_t displayKey;
+    std::uint32_t viewCount;
+    std::uint32_t reserved;
+    CachedView views[kMaxViews];
+    /// hashBytes() of everything above.
+    std::uint64_t checksum;
+};
+
+/// 64-bit FNV-1a.
+inline std::uint64_t hashBytes(const void *data, std::size_t size,
+                               std::uint64_t hash = 14695981039346656037ull) {
+    auto bytes = static_cast<const unsigned char *>(data);
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+inline std::uint64_t hashString(std::string const &s) {
+    return hashBytes(s.data(), s.size());
+}
+
+/// The user's temp directory, with a trailing separator.
+inline std::string tempDirectory() {
+    const char *dir = nullptr;
+    const char *vars[] = {"TMPDIR", "TEMP", "TMP"};
+    for (auto var : vars) {
+        dir = std::getenv(var);
+        if (dir != nullptr && *dir != '\0') {
+            break;
+        }
+        dir = nullptr;
+    }
+#ifdef _WIN32
+    std::string ret = dir != nullptr ? dir : ".";
+    ret += '\\';
+#else
+    std::string ret = dir != nullptr ? dir : "/tmp";
+    ret += '/';
+#endif
+    return ret;
+}
+
+/// The user's temp directory, plus the cache file name.
+inline std::string defaultPath() {
+    return tempDirectory() + "osvrUnityRenderingPlugin-warmstart.bin";
+}
+
+/// Reads up to kMaxViews views into @p views. Returns the number read, 0 if
+/// the file is missing or invalid.
+inline std::size_t load(std::string const &path, std::uint64_t &displayKey,
+                        CachedView (&views)[kMaxViews]) {
+    std::FILE *f = std::fopen(path.c_str(), "rb");
+    if (f == nullptr) {
+        return 0;
+    }
+    File file;
+    const bool read = std::fread(&file, sizeof(file), 1, f) == 1;
+    std::fclose(f);
+    if (!read || file.magic != kMagic || file.version != kVersion ||
+        file.viewCount > kMaxViews ||
+        file.checksum != hashBytes(&file, offsetof(File, checksum))) {
+        return 0;
+    }
+    displayKey = file.displayKey;
+    for (std::uint32_t i = 0; i < file.viewCount; ++i) {
+        views[i] = file.views[i];
+    }
+    return file.viewCount;
+}
+
+/// Writes the file next to @p path and then moves it into place, so a
+/// reader never sees half a file.
+inline bool save(std::string const &path, std::uint64_t displayKey,
+                 CachedView const *views, std::size_t viewCount) {
+    if (viewCount > kMaxViews) {
+        viewCount = kMaxViews;
+    }
+    File file = {};
+    file.magic = kMagic;
+    file.version = kVersion;
+    file.displayKey = displayKey;
+    file.viewCount = static_cast<std::uint32_t>(viewCount);
+    for (std::size_t i = 0; i < viewCount; ++i) {
+        file.views[i] = views[i];
+    }
+    file.checksum = hashBytes(&file, offsetof(File, checksum));
+
+    const std::string tempPath = path + ".tmp";
+    std::FILE *f = std::fopen(tempPath.c_str(), "wb");
+    if (f == nullptr) {
+        return false;
+    }
+    const bool written = std::fwrite(&file, sizeof(file), 1, f) == 1;
+    if (std::fclose(f) != 0 || !written) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    // rename() won't replace an existing file on Windows.
+    std::remove(path.c_str());
+    return std::rename(tempPath.c_str(), path.c_str()) == 0;
+}
+} // namespace renderinfocache
+
+/// @}
+
+#endif // INCLUDED_RenderInfoCache_h_GUID_6E1B9C47_A2D0_4F35_8C6E_0B7D45A93F18
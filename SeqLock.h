@@ -0,0 +1,105 @@
+/** @file
+    @brief Header
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Sensics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_SeqLock_h_GUID_5E2B8C41_7D0A_4F6B_9A3E_1C6F2D9B8E47
+#define INCLUDED_SeqLock_h_GUID_5E2B8C41_7D0A_4F6B_9A3E_1C6F2D9B8E47
+
+// Internal Includes
+// - none
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+/// A sequence lock around a trivially-copyable value: readers never block the
+/// writer and never block each other, they just retry if they raced a write.
+///
+/// Only one writer may call store() at a time - serialize writers externally
+/// if there can be more than one.
+template <typename T> class SeqLock {
+  public:
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "SeqLock can only protect trivially-copyable types.");
+
+    /// Publish a new value.
+    void store(T const &value) {
+        const auto seq = seq_.load(std::memory_order_relaxed);
+        // Odd sequence number means "write in progress".
+        seq_.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(static_cast<void *>(&value_), &value, sizeof(T));
+        seq_.store(seq + 2, std::memory_order_release);
+    }
+
+    /// Copy out a consistent value.
+    void load(T &out) const {
+        read([&](T const &v) {
+            std::memcpy(static_cast<void *>(&out), &v, sizeof(T));
+            return 0;
+        });
+    }
+
+    T load() const {
+        T ret;
+        load(ret);
+        return ret;
+    }
+
+    /// Calls @p f with the protected value and returns what it returns,
+    /// retrying until the call didn't overlap a store(). @p f must only copy
+    /// data out: it may see a torn value on the attempts that get discarded.
+    template <typename F>
+    auto read(F &&f) const -> decltype(f(std::declval<T const &>())) {
+        for (;;) {
+            const auto before = seq_.load(std::memory_order_acquire);
+            if (before & 1u) {
+                std::this_thread::yield();
+                continue;
+            }
+            auto ret = f(value_);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq_.load(std::memory_order_relaxed) == before) {
+                return ret;
+            }
+        }
+    }
+
+    /// Number of completed stores so far.
+    std::uint64_t generation() const {
+        return seq_.load(std::memory_order_acquire) / 2;
+    }
+
+  private:
+    std::atomic<std::uint64_t> seq_{0};
+    T value_ = {};
+};
+
+#endif // INCLUDED_SeqLock_h_GUID_5E2B8C41_7D0A_4F6B_9A3E_1C6F2D9B8E47
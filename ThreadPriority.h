@@ -0,0 +1,125 @@
+/** @file
+    @brief Header
+
+    @date 2016
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2016 Sensics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef INCLUDED_ThreadPriority_h_GUID_5F0C8E27_D913_4A6B_B47E_92A1C3D86E05
+#define INCLUDED_ThreadPriority_h_GUID_5F0C8E27_D913_4A6B_B47E_92A1C3D86E05
+
+// Internal Includes
+#include "PluginConfig.h"
+
+// Library/third-party includes
+#if UNITY_WIN
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+#if UNITY_LINUX
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Standard includes
+#include <cstdint>
+
+/// @name Scheduling of plugin-owned threads
+///
+/// Both functions apply to the calling thread and return false if the OS
+/// refused (e.g. raising priority often needs extra privileges outside
+/// Windows) or doesn't support the request; the thread keeps running either
+/// way.
+/// @{
+
+namespace threadpriority {
+
+enum class Priority {
+    Normal,
+    /// Ahead of ordinary application threads.
+    High,
+    /// Ahead of nearly everything; only for short bursts of work.
+    Realtime
+};
+
+inline bool setCurrentThreadPriority(Priority priority) {
+#if UNITY_WIN
+    int value = THREAD_PRIORITY_NORMAL;
+    if (priority == Priority::High) {
+        value = THREAD_PRIORITY_HIGHEST;
+    } else if (priority == Priority::Realtime) {
+        value = THREAD_PRIORITY_TIME_CRITICAL;
+    }
+    return SetThreadPriority(GetCurrentThread(), value) != 0;
+#elif UNITY_OSX
+    qos_class_t qos = QOS_CLASS_DEFAULT;
+    if (priority != Priority::Normal) {
+        qos = QOS_CLASS_USER_INTERACTIVE;
+    }
+    return pthread_set_qos_class_self_np(qos, 0) == 0;
+#else
+    if (priority == Priority::Realtime) {
+        sched_param param = {};
+        param.sched_priority = sched_get_priority_max(SCHED_FIFO);
+        return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) ==
+               0;
+    }
+    // On Linux, the nice value is per thread.
+    const auto tid = static_cast<id_t>(syscall(SYS_gettid));
+    return setpriority(PRIO_PROCESS, tid,
+                       priority == Priority::High ? -10 : 0) == 0;
+#endif
+}
+
+/// Restricts the calling thread to the CPUs whose bits are set in @p mask
+/// (bit 0 is the first CPU). A mask of 0 leaves the affinity alone.
+inline bool setCurrentThreadAffinity(std::uint64_t mask) {
+    if (mask == 0) {
+        return true;
+    }
+#if UNITY_WIN
+    return SetThreadAffinityMask(GetCurrentThread(),
+                                 static_cast<DWORD_PTR>(mask)) != 0;
+#elif UNITY_LINUX
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    for (int cpu = 0; cpu < 64 && cpu < CPU_SETSIZE; ++cpu) {
+        if ((mask >> cpu) & 1) {
+            CPU_SET(cpu, &cpus);
+        }
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+#else
+    // macOS has no way to pin a thread to a CPU.
+    return false;
+#endif
+}
+} // namespace threadpriority
+
+/// @}
+
+#endif // INCLUDED_ThreadPriority_h_GUID_5F0C8E27_D913_4A6B_B47E_92A1C3D86E05
@@ -38,6 +38,9 @@
 /// avoids spurious "unhandled cases in switch" warnings".
 enum class OSVRSupportedRenderers {
     EmptyRenderer,
+    /// Unity's "null" device (batch mode): there's nothing to render with, but
+    /// it can drive a backend that doesn't need a GPU (MockRenderBackend).
+    Null,
 #if SUPPORT_D3D11
     D3D11,
 #endif
@@ -73,9 +76,12 @@ class UnityRendererType {
             supported_ = true;
             break;
 #endif
+        case kUnityGfxRendererNull:
+            renderer_ = OSVRSupportedRenderers::Null;
+            supported_ = true;
+            break;
         case kUnityGfxRendererD3D9:
         case kUnityGfxRendererGCM:
-        case kUnityGfxRendererNull:
         case kUnityGfxRendererXenon:
         case kUnityGfxRendererOpenGLES20:
         case kUnityGfxRendererOpenGLES30: